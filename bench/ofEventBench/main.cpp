@@ -0,0 +1,429 @@
+#include "ofEvent.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ofEvent dispatch microbenchmarks: notify latency against listener count,
+// add/remove churn and contended notify, for int and void payloads under
+// std::recursive_mutex and NoopMutex. Prints one CSV row per case.
+//
+//   ofEventBench [--reps N] [--min-ms N] [--filter text] [--out results.csv]
+//                [--baseline old.csv [--tolerance percent]]
+
+using std::string;
+using std::vector;
+using Clock = std::chrono::steady_clock;
+typedef std::unique_ptr<of::priv::AbstractEventToken> Token;
+
+namespace {
+
+struct Options {
+	int reps = 9;               // Timed repetitions per case, the median is reported
+	double minMillis = 20.0;    // Each repetition runs at least this long
+	string filter;              // Only cases whose name contains this
+	string outPath;
+	string baselinePath;
+	double tolerance = 5.0;     // Percent slower than the baseline that counts as a regression
+};
+Options options;
+
+struct Result {
+	string benchmark;
+	string payload;
+	string mutex;
+	int listeners = 0;
+	int threads = 1;
+	uint64_t iterations = 0;    // Per repetition
+	double medianNs = 0;        // Per operation
+	double minNs = 0;
+	double madPercent = 0;      // Median absolute deviation, as a share of the median
+};
+vector<Result> results;
+
+// Listeners write here so calls can't be optimized away; thread_local keeps
+// contended runs free of shared writes
+thread_local uint64_t sink = 0;
+
+struct Listener {
+	void onInt(int & value){ sink += value; }
+	void onVoid(){ sink++; }
+};
+
+// Payload-specific glue so each benchmark is written once
+template<typename Mutex>
+Token listen(ofEvent<int,Mutex> & event, Listener & listener){
+	return event.newListener(&listener, &Listener::onInt);
+}
+
+template<typename Mutex>
+Token listen(ofEvent<void,Mutex> & event, Listener & listener){
+	return event.newListener(&listener, &Listener::onVoid);
+}
+
+template<typename Mutex>
+Token listenLambda(ofEvent<int,Mutex> & event){
+	return event.newListener([](int & value){ sink += value; });
+}
+
+template<typename Mutex>
+Token listenLambda(ofEvent<void,Mutex> & event){
+	return event.newListener([]{ sink++; });
+}
+
+template<typename Mutex>
+inline void fire(ofEvent<int,Mutex> & event){
+	int value = 1;
+	event.notify(value);
+}
+
+template<typename Mutex>
+inline void fire(ofEvent<void,Mutex> & event){
+	event.notify();
+}
+
+double elapsedNs(Clock::time_point start){
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+double median(vector<double> values){
+	std::sort(values.begin(), values.end());
+	size_t mid = values.size() / 2;
+	return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+string caseName(const Result & result){
+	std::ostringstream name;
+	name << result.benchmark << "/" << result.payload << "/" << result.mutex
+		<< "/listeners=" << result.listeners << "/threads=" << result.threads;
+	return name.str();
+}
+
+void printRow(FILE * file, const Result & r){
+	fprintf(file, "%s,%s,%s,%d,%d,%llu,%.2f,%.2f,%.2f\n", r.benchmark.c_str(), r.payload.c_str(), r.mutex.c_str(),
+		r.listeners, r.threads, (unsigned long long)r.iterations, r.medianNs, r.minNs, r.madPercent);
+	fflush(file);
+}
+
+const char * CSV_HEADER = "benchmark,payload,mutex,listeners,threads,iterations,median_ns,min_ns,mad_pct\n";
+
+// Calibrates the iteration count to options.minMillis, then times
+// options.reps repetitions. run(n) performs n iterations and returns the
+// elapsed nanoseconds; each iteration counts as opsPerIteration operations.
+template<typename Run>
+void measure(Result result, double opsPerIteration, Run run){
+	string name = caseName(result);
+	if(!options.filter.empty() && name.find(options.filter) == string::npos){
+		return;
+	}
+
+	uint64_t iterations = 1;
+	while(run(iterations) < options.minMillis * 1e6 && iterations < (1ull << 32)){
+		iterations *= 2;
+	}
+	run(iterations); // Warm-up at full length
+
+	vector<double> perOp;
+	for(int rep = 0; rep < options.reps; rep++){
+		perOp.push_back(run(iterations) / (iterations * opsPerIteration));
+	}
+	result.iterations = iterations;
+	result.medianNs = median(perOp);
+	result.minNs = *std::min_element(perOp.begin(), perOp.end());
+	vector<double> deviations;
+	for(double value: perOp){
+		deviations.push_back(std::fabs(value - result.medianNs));
+	}
+	result.madPercent = result.medianNs > 0 ? median(deviations) / result.medianNs * 100.0 : 0.0;
+
+	printRow(stdout, result);
+	results.push_back(result);
+}
+
+Result makeCase(const char * benchmark, const char * payload, const char * mutex, int listeners, int threads = 1){
+	Result result;
+	result.benchmark = benchmark;
+	result.payload = payload;
+	result.mutex = mutex;
+	result.listeners = listeners;
+	result.threads = threads;
+	return result;
+}
+
+// Single-thread notify() against listener count
+template<typename Payload, typename Mutex>
+void benchNotify(const char * payload, const char * mutex){
+	for(int count: {1, 2, 4, 8, 16, 32, 64}){
+		ofEvent<Payload,Mutex> event;
+		vector<Listener> listeners(count);
+		vector<Token> tokens;
+		for(auto & listener: listeners){
+			tokens.push_back(listen(event, listener));
+		}
+		measure(makeCase("notify", payload, mutex, count), 1, [&](uint64_t n){
+			auto start = Clock::now();
+			for(uint64_t i = 0; i < n; i++){
+				fire(event);
+			}
+			return elapsedNs(start);
+		});
+	}
+}
+
+// One add + remove pair on an event that already has `count` listeners
+template<typename Payload, typename Mutex>
+void benchChurn(const char * payload, const char * mutex){
+	for(int count: {0, 16, 64}){
+		ofEvent<Payload,Mutex> event;
+		vector<Listener> listeners(count + 1);
+		vector<Token> tokens;
+		for(int i = 0; i < count; i++){
+			tokens.push_back(listen(event, listeners[i]));
+		}
+		Listener & extra = listeners.back();
+		measure(makeCase("churn_member", payload, mutex, count), 1, [&](uint64_t n){
+			auto start = Clock::now();
+			for(uint64_t i = 0; i < n; i++){
+				Token token = listen(event, extra);
+			}
+			return elapsedNs(start);
+		});
+		measure(makeCase("churn_lambda", payload, mutex, count), 1, [&](uint64_t n){
+			auto start = Clock::now();
+			for(uint64_t i = 0; i < n; i++){
+				Token token = listenLambda(event);
+			}
+			return elapsedNs(start);
+		});
+	}
+}
+
+// Subscribe `count` listeners, then destroy their tokens in order (window
+// reset / shutdown), per listener
+template<typename Payload, typename Mutex>
+void benchTeardown(const char * payload, const char * mutex){
+	for(int count: {64, 256, 1024}){
+		vector<Listener> listeners(count);
+		vector<Token> tokens;
+		tokens.reserve(count);
+		measure(makeCase("teardown", payload, mutex, count), count, [&](uint64_t n){
+			double total = 0;
+			for(uint64_t round = 0; round < n; round++){
+				ofEvent<Payload,Mutex> event;
+				auto start = Clock::now();
+				for(auto & listener: listeners){
+					tokens.push_back(listen(event, listener));
+				}
+				for(auto & token: tokens){
+					token.reset();
+				}
+				total += elapsedNs(start);
+				tokens.clear();
+			}
+			return total;
+		});
+	}
+}
+
+// `threads` threads notifying one event with 8 listeners: latency per notify
+// as each thread sees it. Needs a real mutex.
+template<typename Payload, typename Mutex>
+void benchContended(const char * payload, const char * mutex){
+	const int count = 8;
+	unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	for(int threads: {1, 2, 4, 8}){
+		if(threads > (int)hardware){
+			break;
+		}
+		ofEvent<Payload,Mutex> event;
+		vector<Listener> listeners(count);
+		vector<Token> tokens;
+		for(auto & listener: listeners){
+			tokens.push_back(listen(event, listener));
+		}
+		measure(makeCase("notify_contended", payload, mutex, count, threads), 1, [&](uint64_t n){
+			std::atomic<int> ready{0};
+			std::atomic<bool> go{false};
+			vector<std::thread> workers;
+			for(int t = 0; t < threads; t++){
+				workers.emplace_back([&]{
+					ready++;
+					while(!go.load(std::memory_order_acquire)){}
+					for(uint64_t i = 0; i < n; i++){
+						fire(event);
+					}
+				});
+			}
+			while(ready.load() < threads){}
+			auto start = Clock::now();
+			go.store(true, std::memory_order_release);
+			for(auto & worker: workers){
+				worker.join();
+			}
+			return elapsedNs(start);
+		});
+	}
+}
+
+// One thread notifying (8 listeners) while another keeps adding and removing
+// a listener: notify latency under writer churn. Needs a real mutex.
+template<typename Payload>
+void benchNotifyUnderChurn(const char * payload){
+	const int count = 8;
+	ofEvent<Payload> event;
+	vector<Listener> listeners(count + 1);
+	vector<Token> tokens;
+	for(int i = 0; i < count; i++){
+		tokens.push_back(listen(event, listeners[i]));
+	}
+	measure(makeCase("notify_under_churn", payload, "recursive_mutex", count, 2), 1, [&](uint64_t n){
+		std::atomic<bool> done{false};
+		std::thread writer([&]{
+			while(!done.load(std::memory_order_relaxed)){
+				Token token = listen(event, listeners.back());
+			}
+		});
+		auto start = Clock::now();
+		for(uint64_t i = 0; i < n; i++){
+			fire(event);
+		}
+		double ns = elapsedNs(start);
+		done = true;
+		writer.join();
+		return ns;
+	});
+}
+
+template<typename Payload>
+void benchPayload(const char * payload){
+	benchNotify<Payload,std::recursive_mutex>(payload, "recursive_mutex");
+	benchNotify<Payload,of::priv::NoopMutex>(payload, "noop_mutex");
+	benchChurn<Payload,std::recursive_mutex>(payload, "recursive_mutex");
+	benchChurn<Payload,of::priv::NoopMutex>(payload, "noop_mutex");
+	benchTeardown<Payload,std::recursive_mutex>(payload, "recursive_mutex");
+	benchTeardown<Payload,of::priv::NoopMutex>(payload, "noop_mutex");
+	// NoopMutex events are single-threaded, notify included
+	benchContended<Payload,std::recursive_mutex>(payload, "recursive_mutex");
+	benchNotifyUnderChurn<Payload>(payload);
+}
+
+// Compile check: openFrameworks itself declares events of abstract types
+// (ofEvent<ofAbstractParameter>), so everything but notifyDeferred /
+// drainDeferred has to build without copying the payload
+struct AbstractPayload {
+	virtual ~AbstractPayload(){}
+	virtual int value() const = 0;
+};
+
+struct ConcretePayload: AbstractPayload {
+	int value() const override { return 1; }
+};
+
+void notifyAbstractPayload(){
+	ofEvent<AbstractPayload> event;
+	Token token = event.newListener([](AbstractPayload & payload){ sink += payload.value(); });
+	ConcretePayload payload;
+	event.notify(payload);
+	ofEvent<AbstractPayload> copy(event);
+	copy = event;
+	sink += copy.size() + event.getDeferredPending() + event.getDeferredHighWater() + event.getDeferredDropped();
+}
+
+// Compares against an earlier run's CSV; returns the number of regressions
+int compareWithBaseline(const string & path){
+	std::ifstream file(path);
+	if(!file){
+		fprintf(stderr, "Can't read baseline %s\n", path.c_str());
+		return 1;
+	}
+
+	std::map<string, double> baseline;
+	string line;
+	std::getline(file, line); // Header
+	while(std::getline(file, line)){
+		vector<string> fields;
+		std::stringstream row(line);
+		string field;
+		while(std::getline(row, field, ',')){
+			fields.push_back(field);
+		}
+		if(fields.size() < 9){
+			continue;
+		}
+		Result r = makeCase(fields[0].c_str(), fields[1].c_str(), fields[2].c_str(), std::atoi(fields[3].c_str()), std::atoi(fields[4].c_str()));
+		baseline[caseName(r)] = std::atof(fields[6].c_str());
+	}
+
+	int regressions = 0;
+	fprintf(stderr, "\n%-60s %10s %10s %8s\n", "case", "base ns", "now ns", "change");
+	for(auto & result: results){
+		string name = caseName(result);
+		auto it = baseline.find(name);
+		if(it == baseline.end() || it->second <= 0){
+			continue;
+		}
+		double change = (result.medianNs / it->second - 1.0) * 100.0;
+		bool regressed = change > options.tolerance;
+		regressions += regressed;
+		fprintf(stderr, "%-60s %10.2f %10.2f %+7.1f%%%s\n", name.c_str(), it->second, result.medianNs, change,
+			regressed ? "  REGRESSION" : "");
+	}
+	fprintf(stderr, "%d regression(s) beyond %.1f%%\n", regressions, options.tolerance);
+	return regressions;
+}
+
+}
+
+int main(int argc, char * argv[]){
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if(arg == "--reps" && hasValue){
+			options.reps = std::max(1, std::atoi(argv[++i]));
+		}else if(arg == "--min-ms" && hasValue){
+			options.minMillis = std::max(0.1, std::atof(argv[++i]));
+		}else if(arg == "--filter" && hasValue){
+			options.filter = argv[++i];
+		}else if(arg == "--out" && hasValue){
+			options.outPath = argv[++i];
+		}else if(arg == "--baseline" && hasValue){
+			options.baselinePath = argv[++i];
+		}else if(arg == "--tolerance" && hasValue){
+			options.tolerance = std::atof(argv[++i]);
+		}else{
+			fprintf(stderr, "Usage: %s [--reps N] [--min-ms N] [--filter text] [--out results.csv] "
+				"[--baseline old.csv [--tolerance percent]]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	notifyAbstractPayload();
+	fputs(CSV_HEADER, stdout);
+	benchPayload<int>("int");
+	benchPayload<void>("void");
+
+	if(!options.outPath.empty()){
+		FILE * out = fopen(options.outPath.c_str(), "w");
+		if(!out){
+			fprintf(stderr, "Can't write %s\n", options.outPath.c_str());
+			return 1;
+		}
+		fputs(CSV_HEADER, out);
+		for(auto & result: results){
+			printRow(out, result);
+		}
+		fclose(out);
+	}
+
+	if(!options.baselinePath.empty()){
+		return compareWithBaseline(options.baselinePath) > 0 ? 1 : 0;
+	}
+	return 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Stand-in for openFrameworks' ofConstants.h: all ofEvent.h needs from it,
+// so the benchmark builds without the rest of openFrameworks
+#if defined(__GNUC__) || defined(__clang__)
+#define OF_DEPRECATED_MSG(message, func) func __attribute__ ((deprecated(message)))
+#elif defined(_MSC_VER)
+#define OF_DEPRECATED_MSG(message, func) __declspec(deprecated(message)) func
+#else
+#define OF_DEPRECATED_MSG(message, func) func
+#endif
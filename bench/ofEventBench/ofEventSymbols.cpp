@@ -0,0 +1,7 @@
+#include "ofEvent.h"
+
+// Out-of-line definitions openFrameworks keeps in ofEvent.cpp
+of::priv::AbstractEventToken::~AbstractEventToken(){}
+of::priv::BaseFunctionId::~BaseFunctionId(){}
+of::priv::StdFunctionId::~StdFunctionId(){}
+std::atomic<uint_fast64_t> of::priv::StdFunctionId::nextId{0};
@@ -0,0 +1,138 @@
+#include "BenchmarkRunner.h"
+
+// Fixed seed so the source shuffles happen the same way every run
+#define BENCHMARK_RANDOM_SEED 1234
+
+static float percentile(vector<float> values, float fraction) {
+	if (values.empty()) {
+		return 0.0f;
+	}
+	size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+void BenchmarkRunner::setup(const vector<shared_ptr<ofAppBaseWindow>>& benchmarkWindows, DisplayManager* displayManager,
+                            int warmup, int measured) {
+	windows = benchmarkWindows;
+	manager = displayManager;
+	warmupFrames = std::max(0, warmup);
+	measuredFrames = std::max(1, measured);
+	cycleMillis.reserve(measuredFrames);
+	updateMillis.reserve(measuredFrames);
+	ofSeedRandom(BENCHMARK_RANDOM_SEED);
+}
+
+int BenchmarkRunner::run() {
+	auto mainLoop = ofGetMainLoop();
+	ofLogNotice() << "Benchmark: " << windows.size() << " outputs, " << warmupFrames << " warm-up + "
+		<< measuredFrames << " measured frames";
+
+	// Warm up until setup has run and the pipeline has filled
+	int warmed = 0;
+	while (warmed < warmupFrames || !manager->isSetup()) {
+		mainLoop->pollEvents();
+		renderCycle();
+		warmed++;
+	}
+	cycleMillis.clear();
+	updateMillis.clear();
+
+	const FaceDetector& detector = manager->getFaceDetector();
+	startCounters = manager->getCounters();
+	startDetections = detector.getDetectionCount();
+	startDetectMicros = detector.getDetectMicros();
+	startTracked = detector.getTrackedFrameCount();
+	startTrackMicros = detector.getTrackMicros();
+	startMicros = ofGetElapsedTimeMicros();
+
+	for (int i = 0; i < measuredFrames; i++) {
+		mainLoop->pollEvents();
+		renderCycle();
+	}
+
+	report();
+
+	for (auto & window : windows) {
+		window->setWindowShouldClose();
+	}
+	mainLoop->exit();
+	return 0;
+}
+
+void BenchmarkRunner::renderCycle() {
+	auto mainLoop = ofGetMainLoop();
+	uint64_t cycleStart = ofGetElapsedTimeMicros();
+
+	for (size_t i = 0; i < windows.size(); i++) {
+		mainLoop->setCurrentWindow(windows[i]);
+		windows[i]->makeCurrent();
+
+		uint64_t updateStart = ofGetElapsedTimeMicros();
+		windows[i]->update();
+		if (i == 0) {
+			updateMillis.push_back((ofGetElapsedTimeMicros() - updateStart) / 1000.0f);
+		}
+		windows[i]->draw();
+	}
+
+	// Make sure the GPU work is counted in the frame that issued it
+	glFinish();
+	cycleMillis.push_back((ofGetElapsedTimeMicros() - cycleStart) / 1000.0f);
+}
+
+void BenchmarkRunner::report() {
+	const FaceDetector& detector = manager->getFaceDetector();
+	PipelineCounters end = manager->getCounters();
+	float seconds = (ofGetElapsedTimeMicros() - startMicros) / 1000000.0f;
+
+	uint64_t detections = detector.getDetectionCount() - startDetections;
+	uint64_t tracked = detector.getTrackedFrameCount() - startTracked;
+	uint64_t webcamUploads = end.webcamUploads - startCounters.webcamUploads;
+	uint64_t videoUploads = end.videoUploads - startCounters.videoUploads;
+	uint64_t decoded = end.videoDecodedFrames - startCounters.videoDecodedFrames;
+
+	float detectMillis = detections > 0 ? (detector.getDetectMicros() - startDetectMicros) / 1000.0f / detections : 0.0f;
+	float trackMillis = tracked > 0 ? (detector.getTrackMicros() - startTrackMicros) / 1000.0f / tracked : 0.0f;
+	float decodeMillis = decoded > 0 ? (end.videoDecodeMicros - startCounters.videoDecodeMicros) / 1000.0f / decoded : 0.0f;
+	float webcamUploadMillis = webcamUploads > 0 ? (end.webcamUploadMicros - startCounters.webcamUploadMicros) / 1000.0f / webcamUploads : 0.0f;
+	float videoUploadMillis = videoUploads > 0 ? (end.videoUploadMicros - startCounters.videoUploadMicros) / 1000.0f / videoUploads : 0.0f;
+	uint64_t webcamUploadBytes = webcamUploads > 0 ? (end.webcamUploadBytes - startCounters.webcamUploadBytes) / webcamUploads : 0;
+	uint64_t videoUploadBytes = videoUploads > 0 ? (end.videoUploadBytes - startCounters.videoUploadBytes) / videoUploads : 0;
+
+	float p50 = percentile(cycleMillis, 0.50f);
+	float p95 = percentile(cycleMillis, 0.95f);
+	float p99 = percentile(cycleMillis, 0.99f);
+	float updateP50 = percentile(updateMillis, 0.50f);
+
+	ofLogNotice() << "Benchmark frame time: p50 " << p50 << "ms, p95 " << p95 << "ms, p99 " << p99
+		<< "ms (update p50 " << updateP50 << "ms) - " << cycleMillis.size() / seconds << " cycles/s";
+	ofLogNotice() << "Benchmark detection: " << detections << " cascade runs at " << detectMillis << "ms, "
+		<< tracked << " tracked frames at " << trackMillis << "ms";
+	ofLogNotice() << "Benchmark decode: " << decoded << " frames at " << decodeMillis << "ms, "
+		<< end.videoDroppedFrames - startCounters.videoDroppedFrames << " dropped";
+	ofLogNotice() << "Benchmark upload: webcam " << webcamUploadBytes << " bytes at " << webcamUploadMillis
+		<< "ms, video " << videoUploadBytes << " bytes at " << videoUploadMillis << "ms per frame";
+
+	// One row per run, so builds can be compared side by side
+	ofDirectory::createDirectory("benchmark", true, true);
+	string path = ofToDataPath("benchmark/results.csv", true);
+	bool writeHeader = !ofFile::doesFileExist(path, false);
+	std::ofstream csv(path, std::ios::app);
+	if (!csv) {
+		ofLogError() << "Could not write " << path;
+		return;
+	}
+	if (writeHeader) {
+		csv << "timestamp,build,outputs,frames,p50_ms,p95_ms,p99_ms,update_p50_ms,"
+			<< "detections,detect_ms,tracked,track_ms,decoded,decode_ms,"
+			<< "webcam_upload_bytes,webcam_upload_ms,video_upload_bytes,video_upload_ms\n";
+	}
+	csv << ofGetTimestampString("%Y-%m-%d %H:%M:%S") << "," << __DATE__ " " __TIME__ << ","
+		<< windows.size() << "," << cycleMillis.size() << ","
+		<< p50 << "," << p95 << "," << p99 << "," << updateP50 << ","
+		<< detections << "," << detectMillis << "," << tracked << "," << trackMillis << ","
+		<< decoded << "," << decodeMillis << ","
+		<< webcamUploadBytes << "," << webcamUploadMillis << "," << videoUploadBytes << "," << videoUploadMillis << "\n";
+	ofLogNotice() << "Benchmark results appended to " << path;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ofMain.h"
+#include "DisplayManager.h"
+
+// Runs the update() + draw() cycle for every output as fast as possible
+// (no vsync, no pacing) and reports frame time percentiles plus per-stage
+// detection, decode and upload cost. Results are also appended to
+// data/benchmark/results.csv so runs can be compared between builds.
+class BenchmarkRunner {
+public:
+    void setup(const vector<shared_ptr<ofAppBaseWindow>>& windows, DisplayManager* manager,
+               int warmupFrames, int measuredFrames);
+    int run();
+
+private:
+    void renderCycle();
+    void report();
+
+    vector<shared_ptr<ofAppBaseWindow>> windows;
+    DisplayManager* manager = nullptr;
+    int warmupFrames = 120;
+    int measuredFrames = 1200;
+
+    vector<float> cycleMillis;   // Whole cycle: every window's update + draw
+    vector<float> updateMillis;  // Window 0's update (DisplayManager::update)
+    PipelineCounters startCounters;
+    uint64_t startDetections = 0;
+    uint64_t startDetectMicros = 0;
+    uint64_t startTracked = 0;
+    uint64_t startTrackMicros = 0;
+    uint64_t startMicros = 0;
+};
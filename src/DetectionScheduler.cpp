@@ -0,0 +1,50 @@
+#include "DetectionScheduler.h"
+#include "ofMain.h"
+
+void DetectionScheduler::setBudget(float millisPerFrame) {
+	budgetMillis = std::max(0.1f, millisPerFrame);
+}
+
+void DetectionScheduler::setIntervalRange(int minFrames, int maxFrames) {
+	minInterval = std::max(1, minFrames);
+	maxInterval = std::max(minInterval, maxFrames);
+	interval = std::min(std::max(interval, minInterval), maxInterval);
+}
+
+void DetectionScheduler::recordDetection(float detectMillis, int consecutiveDetections) {
+	// Smooth the measured cost so one slow call doesn't swing the rate
+	if (!hasAverage) {
+		averageDetectMillis = detectMillis;
+		hasAverage = true;
+	} else {
+		averageDetectMillis = ofLerp(averageDetectMillis, detectMillis, 0.1f);
+	}
+
+	updateInterval(consecutiveDetections);
+}
+
+void DetectionScheduler::recordSkippedDetection(int consecutiveDetections) {
+	updateInterval(consecutiveDetections);
+}
+
+void DetectionScheduler::updateInterval(int consecutiveDetections) {
+	// Fastest rate that keeps the average cost per webcam frame within budget
+	int budgetInterval = (int)std::ceil(averageDetectMillis / budgetMillis);
+
+	if (consecutiveDetections > 0) {
+		// Face present and count climbing - detect as often as the budget allows
+		emptyDetections = 0;
+		interval = budgetInterval;
+	} else {
+		// Nobody there - double the interval every 10 empty detections
+		emptyDetections++;
+		int backoff = 1 << std::min(emptyDetections / 10, 4);
+		interval = std::max(budgetInterval, 1) * backoff;
+	}
+
+	interval = std::min(std::max(interval, minInterval), maxInterval);
+}
+
+float DetectionScheduler::getBudgetUse() const {
+	return averageDetectMillis / interval / budgetMillis;
+}
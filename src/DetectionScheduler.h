@@ -0,0 +1,33 @@
+#pragma once
+
+// Decides how many webcam frames to skip between face detections.
+// Each findHaarObjects call is timed and the interval is chosen so detection
+// stays inside a per-frame CPU budget; it detects as often as the budget
+// allows while a face is being tracked and backs off when nobody is there.
+class DetectionScheduler {
+public:
+    void setBudget(float millisPerFrame);
+    void setIntervalRange(int minFrames, int maxFrames);
+
+    // Call once per detection (detection thread)
+    void recordDetection(float detectMillis, int consecutiveDetections);
+    // Call when the motion gate skipped the cascade (cost not measured)
+    void recordSkippedDetection(int consecutiveDetections);
+
+    int getInterval() const { return interval; }           // Webcam frames per detection
+    float getBudget() const { return budgetMillis; }
+    float getBudgetUse() const;                             // Detection cost / budget (1.0 = at budget)
+    float getAverageDetectMillis() const { return averageDetectMillis; }
+
+private:
+    void updateInterval(int consecutiveDetections);
+
+    float budgetMillis = 4.0f;
+    int minInterval = 1;
+    int maxInterval = 12;
+
+    float averageDetectMillis = 0.0f;
+    bool hasAverage = false;
+    int interval = 3;
+    int emptyDetections = 0;
+};
@@ -1,4 +1,8 @@
 #include "DisplayApp.h"
+#include "PerfTimers.h"
+
+// Timers run while any window shows the HUD (or the CSV is streaming)
+static int visiblePerfHuds = 0;
 
 void DisplayApp::init(DisplayManager* mgr, int windowIdx) {
     manager = mgr;
@@ -18,31 +22,43 @@ void DisplayApp::setup() {
     
     // Performance: disable vsync for smoother multi-window rendering
     // Only enable on window 0 to prevent screen tearing
-    if (windowIndex == 0) {
+    if (windowIndex == 0 && !unthrottled) {
         ofSetVerticalSync(true);
     } else {
         ofSetVerticalSync(false);
     }
     
-    ofSetFrameRate(60);
+    // The output scheduler paces presents itself; a per-window limiter would sleep inside draw
+    ofSetFrameRate(externalPacing || unthrottled ? 0 : 60);
 }
 
 void DisplayApp::update() {
+    PerfTimers::setWindowTrack(windowIndex);
+    PERF_SCOPE(PERF_APP_UPDATE);
+    
     // Only window 0 initializes and updates the manager
     if(!initialized && windowIndex == 0 && manager) {
         manager->setup();
         initialized = true;
     }
     if(windowIndex == 0 && manager) {
+        // Events queued by the detection and decode threads are delivered here, before this frame's update
+        manager->drainEvents();
         manager->update();
     }
 }
 
 void DisplayApp::draw() {
+    PerfTimers::setWindowTrack(windowIndex);
+    PERF_SCOPE(PERF_APP_DRAW);
+    
     ofBackground(0);
     // All windows share the same manager and draw
     if(manager && manager->isSetup()) {
         manager->draw(windowIndex);
+        if (showPerfHud) {
+            PerfTimers::drawHud(20, 20);
+        }
     } else {
         // Debug: show which window this is if manager not ready
         ofSetColor(255);
@@ -51,6 +67,14 @@ void DisplayApp::draw() {
 }
 
 void DisplayApp::keyPressed(int key) {
+    // 'p' key toggles the perf HUD on this window
+    if (key == 'p' || key == 'P') {
+        showPerfHud = !showPerfHud;
+        visiblePerfHuds += showPerfHud ? 1 : -1;
+        PerfTimers::setEnabled(visiblePerfHuds > 0);
+        return;
+    }
+    
     // 'f' key toggles fullscreen/borderless on this window
     if (key == 'f' || key == 'F') {
         if (!glfwWindow) return;
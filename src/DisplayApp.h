@@ -8,6 +8,8 @@ class DisplayApp : public ofBaseApp {
 public:
     void init(DisplayManager* mgr, int windowIdx);
     void setGlfwWindow(GLFWwindow* win);
+    void setExternalPacing(bool paced) { externalPacing = paced; } // OutputScheduler drives the frame rate
+    void setUnthrottled(bool enabled) { unthrottled = enabled; }  // Benchmark: no vsync, no frame limit
     void setup() override;
     void update() override;
     void draw() override;
@@ -18,5 +20,8 @@ private:
     int windowIndex = -1;
     bool initialized = false;
     bool isFullscreen = false;
+    bool externalPacing = false;
+    bool unthrottled = false;
+    bool showPerfHud = false;
     GLFWwindow* glfwWindow = nullptr;
 };
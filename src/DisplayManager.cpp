@@ -1,30 +1,101 @@
 #include "DisplayManager.h"
+#include "PerfTimers.h"
 
-// Render resolution (lower = better performance, scales up to fullscreen)
+// Render resolution (lower = better performance, scales up to fullscreen).
+// The starting size of every render FBO, and the webcam's cap under dynamic resolution.
 #define RENDER_WIDTH 640
 #define RENDER_HEIGHT 480
 
+// Compose every output once in window 0's context; other windows only blit (0 = per-window FBO + shader)
+#define SINGLE_CONTEXT_COMPOSITOR 1
+
+// Stream video frames through pixel-unpack buffers (0 = synchronous loadData, for A/B timing)
+#define VIDEO_PBO_STREAMING 1
+
+// Time each render phase on the GPU (GL_TIME_ELAPSED, read back a few frames late), reported every N seconds
+#define GPU_TIMER_QUERIES 1
+#define GPU_REPORT_INTERVAL 10.0f
+
+#if GPU_TIMER_QUERIES
+#define GPU_SCOPE(window, phase, source) ScopedGpuTimer gpuScope##phase(gpuTimers[window], phase, source)
+#else
+#define GPU_SCOPE(window, phase, source)
+#endif
+
+// Face detection CPU budget per webcam frame (tune per installation)
+#define DETECTION_BUDGET_MS 4.0f
+#define DETECTION_MIN_INTERVAL 1   // Detect at most every webcam frame
+#define DETECTION_MAX_INTERVAL 12  // ...and at least every 12th (~0.5s at 24fps)
+
+// Search only around the last face (padding in face widths), full scan every N detections
+#define DETECTION_ROI_PADDING 0.5f
+#define DETECTION_ROI_MAX_MISSES 1
+#define DETECTION_FULL_SCAN_INTERVAL 15
+
+// Skip the cascade while an empty room is unchanged (mean abs diff per pixel, 0-255)
+#define MOTION_GATE_THRESHOLD 2.0f
+#define MOTION_GATE_FORCED_SCAN 30 // ...but still run it every N skipped detections
+#define MOTION_GATE_EMPTY_PROXIMITY 0.05f // Room counts as empty once no face is held and proximity decays below this
+
+// Deferred events delivered per queue per frame (the rest wait for the next), queue high-water marks logged every N seconds
+#define EVENT_DRAIN_BATCH 16
+#define EVENT_REPORT_INTERVAL 10.0f
+
+void DisplayManager::setNumOutputs(int count) {
+	numOutputs = std::max(1, count);
+}
+
+void DisplayManager::setWebcamSource(unique_ptr<FrameSource> source) {
+	webcam = std::move(source);
+}
+
+void DisplayManager::setDynamicResolution(bool enabled, float gpuBudgetMillis) {
+	dynamicResolution = enabled;
+	resolutionBudgetMillis = gpuBudgetMillis;
+}
+
+void DisplayManager::setFixedShowStep(float secondsPerUpdate) {
+	fixedShowStep = std::max(0.0f, secondsPerUpdate);
+}
+
+float DisplayManager::showTime() const {
+	return fixedShowStep > 0.0f ? updateCount * fixedShowStep : ofGetElapsedTimef();
+}
+
+PipelineCounters DisplayManager::getCounters() const {
+	// Add the current decoder's totals to those of the clips already played
+	PipelineCounters total = counters;
+	if (videoDecoder) {
+		total.videoDecodedFrames += videoDecoder->getDecodedFrames();
+		total.videoDecodeMicros += videoDecoder->getDecodeMicros();
+		total.videoDroppedFrames += videoDecoder->getDroppedFrames();
+	}
+	return total;
+}
+
 void DisplayManager::setup() {
 	ofLogNotice() << "DisplayManager::setup() - Starting";
 
 	setupComplete = false;
-	proximity = 0.0f;
-	frameSkip = 2; // Process every 3rd frame for face detection
 	frameCounter = 0;
-	consecutiveDetections = 0;
-	detectionThreshold = 3; // Must detect face in 3+ consecutive processed frames
-	
-	staticImageShowTime = ofGetElapsedTimef();
-	inMirrorMode = false;
-	mirrorModeStartTime = 0;
-	mirrorModeDuration = 0;
-	mirrorSource = 0;
-	lastStaticImageWindow = 2;
-
-	// Reduced resolution for better performance
-	webcam.setDesiredFrameRate(24);  // Limit webcam framerate
-	webcam.setup(320, 240);  // Low resolution, scales up via FBO
-	ofLogNotice() << "Webcam setup complete";
+	counters = PipelineCounters();
+
+	mirrorStates.assign(numOutputs, MirrorState());
+	for (auto & state : mirrorStates) {
+		state.staticImageShowTime = showTime();
+	}
+
+	// A recorded replay (if one was set) stands in for the camera on the same path
+	if (webcam && !webcam->setup()) {
+		ofLogError() << "Webcam replay failed, falling back to the camera";
+		webcam.reset();
+	}
+	if (!webcam) {
+		// Reduced resolution for better performance: 320x240 at 24fps, scales up via FBO
+		webcam = make_unique<CameraFrameSource>(320, 240, 24);
+		webcam->setup();
+	}
+	ofLogNotice() << "Webcam setup complete: " << webcam->describe();
 
 	// Try alternative cascade that sometimes works better
 	string cascadeFile = "haarcascade_frontalface_alt2.xml";
@@ -34,27 +105,33 @@ void DisplayManager::setup() {
 		cascadeFile = "haarcascade_frontalface_default.xml";
 	}
 
-	ofLogNotice() << "Loading cascade: " << cascadeFile;
-	faceFinder.setup(cascadeFile);
-
-	// Optimized for low-res cameras and edge detection
-	faceFinder.setScaleHaar(1.2f); // Faster, still accurate (was 1.1)
-	faceFinder.setNeighbors(2); // Balanced sensitivity (2 = good for low-res + reduces false positives)
-
-	ofLogNotice() << "Face finder setup complete";
-
-	colorImg.allocate(320, 240);
-	grayImg.allocate(320, 240);
+	// Detection runs on its own thread at the webcam's actual resolution
+	int detectWidth = webcam->getWidth() > 0 ? webcam->getWidth() : 320;
+	int detectHeight = webcam->getHeight() > 0 ? webcam->getHeight() : 240;
+	faceDetector.setCpuBudget(DETECTION_BUDGET_MS, DETECTION_MIN_INTERVAL, DETECTION_MAX_INTERVAL);
+	faceDetector.setRoiTracking(true, DETECTION_ROI_PADDING, DETECTION_ROI_MAX_MISSES, DETECTION_FULL_SCAN_INTERVAL);
+	faceDetector.setMotionGate(true, MOTION_GATE_THRESHOLD, MOTION_GATE_FORCED_SCAN, MOTION_GATE_EMPTY_PROXIMITY);
+	ofAddListener(faceDetector.presenceChanged, this, &DisplayManager::onPresenceChanged);
+	faceDetector.setup(cascadeFile, detectWidth, detectHeight);
 	ofLogNotice() << "Face detection setup complete";
 
-	// Allocate vectors for 3 windows (shaders loaded per-window in draw)
-	renderFbos.resize(NUM_OUTPUTS);
-	glitchShaders.resize(NUM_OUTPUTS);
-	webcamTextures.resize(NUM_OUTPUTS);
-	videoTextures.resize(NUM_OUTPUTS);
-	staticImageTextures.resize(NUM_OUTPUTS);
-	lastCopiedVideoFrame.resize(NUM_OUTPUTS, -1);
+#if !SINGLE_CONTEXT_COMPOSITOR
+	// Allocate per-window vectors (shaders and FBO pools created per-window in draw)
+	renderFbos.resize(numOutputs);
+	glitchShaders.resize(numOutputs);
+#endif
+	gpuTimers.assign(numOutputs, GpuTimer());
+	lastGpuReportTime = ofGetElapsedTimef();
+	lastEventReportTime = ofGetElapsedTimef();
+
+	// Every output starts at the fixed render size; compositor mode scales only the webcam composition
+	defaultLevel = ResolutionController::levelFor(RENDER_WIDTH, RENDER_HEIGHT);
+	windowLevelCaps.assign(numOutputs, defaultLevel);
+	resolution.setup(SINGLE_CONTEXT_COMPOSITOR ? 1 : numOutputs, defaultLevel, resolutionBudgetMillis);
+	resolution.setEnabled(dynamicResolution && GPU_TIMER_QUERIES);
+	ofLogNotice() << "Dynamic resolution: " << (resolution.isEnabled() ? "on, " + ofToString(resolutionBudgetMillis) + "ms GPU budget" : "off");
 	videoFrameNumber = 0;
+	videoPboIndex = 0;
 
 	// Load videos from data/movies/
 	ofDirectory dir("movies/");
@@ -63,27 +140,22 @@ void DisplayManager::setup() {
 	dir.allowExt("avi");
 	dir.listDir();
 
+	// Only the paths are kept; each clip is opened by its decoder thread when it plays
 	for (auto & file : dir) {
-		ofVideoPlayer player;
-		player.setUseTexture(false);  // Disable GL texture - avoids AVFoundation context issues
-		ofLogNotice() << "Loading video: " << file.getFileName();
-		if (player.load(file.getAbsolutePath())) {
-			player.setLoopState(OF_LOOP_NORMAL);
-			player.play();
-			videos.push_back(std::move(player));
-			int videoIndex = videos.size() - 1;
-			ofLogNotice() << "Loaded video: " << file.getFileName() 
-				<< " (" << videos[videoIndex].getWidth() << "x" << videos[videoIndex].getHeight() << ")";
-		} else {
-			ofLogError() << "Failed to load video: " << file.getFileName();
-		}
+		videoPaths.push_back(file.getAbsolutePath());
+		ofLogNotice() << "Found video: " << file.getFileName();
 	}
 	hasValidVideoPixels = false;
+	videoLoadFailed.assign(videoPaths.size(), false);
 
-	ofLogNotice() << "Loaded " << videos.size() << " videos";
+	ofLogNotice() << "Found " << videoPaths.size() << " videos";
 	currentVideoIndex = 0;
+	videoSwitchMicros = 0;
+	startVideo(currentVideoIndex);
+	prerollNextVideo();
 
-	// Load static image for window 2
+	// Load static image (pixels only - uploaded once into the shared texture below)
+	staticImage.setUseTexture(false);
 	if (ofFile::doesFileExist("images/test.jpg")) {
 		staticImage.load("images/test.jpg");
 		ofLogNotice() << "Loaded test.jpg: " << staticImage.getWidth() << "x" << staticImage.getHeight() 
@@ -96,136 +168,175 @@ void DisplayManager::setup() {
 		ofLogWarning() << "No static image found in images/ folder";
 	}
 
+	// Upload once (window 0's context); every window samples the shared texture
+	if (staticImage.isAllocated()) {
+		staticImageTexture.loadData(staticImage.getPixels());
+		glFlush();
+	}
+
 
 
-	// Initialize assignments: 0=webcam, 1=current video, 2=static image
-	windowAssignment[0] = 0;
-	windowAssignment[1] = 1;
-	windowAssignment[2] = 2;
+	// Initialize assignments from the source pool: 0=webcam, 1=current video, 2=static image
+	windowAssignment = buildSourcePool();
+	ofLogNotice() << "Driving " << numOutputs << " outputs";
 
 	swapInterval = ofRandom(1.0f, 30.0f); // random 1-30 seconds
-	lastSwapTime = ofGetElapsedTimef();
+	lastSwapTime = showTime();
 
 	setupComplete = true;
 	ofLogNotice() << "DisplayManager setup complete!";
 }
 
+void DisplayManager::drainEvents() {
+	// Oldest first, in bounded batches so a burst can't stall the frame
+	faceDetector.presenceChanged.drainDeferred(EVENT_DRAIN_BATCH);
+	if (videoDecoder) {
+		videoDecoder->clipEnded.drainDeferred(EVENT_DRAIN_BATCH);
+	}
+
+	if (setupComplete && ofGetElapsedTimef() - lastEventReportTime > EVENT_REPORT_INTERVAL) {
+		reportEventQueues();
+		lastEventReportTime = ofGetElapsedTimef();
+	}
+}
+
+void DisplayManager::onPresenceChanged(FacePresence& presence) {
+	ofLogNotice() << (presence.present ? "Face acquired" : "Face lost") << " (proximity " << presence.proximity << ")";
+}
+
+void DisplayManager::onClipEnded(const void* sender) {
+	const VideoDecoder* decoder = static_cast<const VideoDecoder*>(sender);
+	ofLogNotice() << "Clip decoded to the end: " << ofFilePath::getFileName(decoder->getPath())
+		<< ", " << decoder->queueDepth() << " frames still queued";
+}
+
+void DisplayManager::reportEventQueues() {
+	string log = "presence high-water " + ofToString(faceDetector.presenceChanged.getDeferredHighWater()) + ", "
+		+ ofToString(faceDetector.presenceChanged.getDeferredDropped()) + " dropped";
+	faceDetector.presenceChanged.resetDeferredHighWater();
+
+	// Each decoder owns its clip-ended queue: the playing clip and the pre-rolled one
+	VideoDecoder* decoders[] = { videoDecoder.get(), nextVideoDecoder.get() };
+	for (auto decoder : decoders) {
+		if (decoder) {
+			log += "; clip ended (" + ofFilePath::getFileName(decoder->getPath()) + ") high-water "
+				+ ofToString(decoder->clipEnded.getDeferredHighWater()) + ", "
+				+ ofToString(decoder->clipEnded.getDeferredDropped()) + " dropped";
+			decoder->clipEnded.resetDeferredHighWater();
+		}
+	}
+	ofLogNotice() << "Deferred events: " << log;
+}
+
 void DisplayManager::update() {
-	webcam.update();
+	updateCount++;
+	frameTimeStats.add(ofGetLastFrameTime());
+	PerfTimers::collect();
+	{
+		PERF_SCOPE(PERF_CAPTURE);
+		webcam->update();
+	}
 
-	// Only update the current video (not all videos)
-	if (videos.size() > 0 && currentVideoIndex >= 0 && currentVideoIndex < videos.size()) {
-		ofVideoPlayer& video = videos[currentVideoIndex];
-		video.update();
-		
-		// Cache pixels during update (in window 0's context) so all windows can use them
-		if (video.isFrameNew() && video.getPixels().isAllocated()) {
-			cachedVideoPixels = video.getPixels();
+	// Pick up the latest detection result (lock-free, never waits on OpenCV)
+	faceDetector.update();
+
+	// Present the current clip's due frame from the decoder queue
+	if (videoDecoder) {
+		const VideoFrame* frame = videoDecoder->nextDueFrame(ofGetElapsedTimef());
+		if (frame) {
+			// Upload during update (in window 0's context) into the texture all windows share
+			uint64_t uploadStart = ofGetElapsedTimeMicros();
+			{
+				PERF_SCOPE(PERF_UPLOAD);
+				uploadVideoFrame(frame->pixels);
+			}
+			uint64_t uploadMicros = ofGetElapsedTimeMicros() - uploadStart;
+			videoUploadStats.add(uploadMicros);
+			counters.videoUploads++;
+			counters.videoUploadBytes += frame->pixels.getTotalBytes();
+			counters.videoUploadMicros += uploadMicros;
+			videoDecoder->popFrame();
 			hasValidVideoPixels = true;
 			videoFrameNumber++;
+
+			if (videoSwitchMicros > 0) {
+				ofLogNotice() << "Video switch: first frame of clip " << currentVideoIndex << " shown "
+					<< (ofGetElapsedTimeMicros() - videoSwitchMicros) / 1000.0f << "ms after the previous clip ended";
+				videoSwitchMicros = 0;
+			}
+
+			if (videoUploadStats.count >= 120) {
+				ofLogNotice() << "Video upload (" << (VIDEO_PBO_STREAMING ? "PBO" : "sync") << "): "
+					<< videoUploadStats.mean << "us avg, " << videoUploadStats.stddev() << "us stddev, "
+					<< videoUploadStats.maximum << "us max - frame time stddev "
+					<< frameTimeStats.stddev() * 1000.0 << "ms";
+				ofLogNotice() << "Video decode: " << videoDecoder->getDecodeMillis() << "ms/frame, queue "
+					<< videoDecoder->queueDepth() << "/" << VideoDecoder::QUEUE_SIZE << ", "
+					<< videoDecoder->getDroppedFrames() << " dropped of " << videoDecoder->getDecodedFrames();
+				videoUploadStats.reset();
+				frameTimeStats.reset();
+			}
 		}
-	}
 
-	// Check for video end and switch to next
-	if (videos.size() > 0) {
-		ofVideoPlayer& currentVideo = videos[currentVideoIndex];
-		// Check if video reached the end (current frame >= total frames or video stopped)
-		if (currentVideo.getTotalNumFrames() > 0 && 
-		    (currentVideo.getCurrentFrame() >= currentVideo.getTotalNumFrames() - 1 || !currentVideo.isPlaying())) {
-			currentVideoIndex = (currentVideoIndex + 1) % videos.size();
-			reloadVideo(currentVideoIndex);
+		// Switch to the pre-rolled clip once this one has played out (or failed to load)
+		if (videoDecoder->isFinished() || videoDecoder->hasFailed()) {
+			switchToNextVideo();
 		}
 	}
+	reapRetiredVideoDecoders();
 
-	if (webcam.isFrameNew()) {
-		// Frame skipping for performance
-		frameCounter++;
-		if (frameCounter % (frameSkip + 1) != 0) {
-			return; // Skip this frame
-		}
+	if (webcam->isFrameNew()) {
+		const ofPixels& webcamPixels = webcam->getPixels();
 
-		// Ensure images match webcam size (safety check)
-		if (colorImg.width != webcam.getWidth() || colorImg.height != webcam.getHeight()) {
-			colorImg.allocate(webcam.getWidth(), webcam.getHeight());
-			grayImg.allocate(webcam.getWidth(), webcam.getHeight());
-			ofLogNotice() << "Reallocated CV images to match webcam: " 
-						  << webcam.getWidth() << "x" << webcam.getHeight();
+		// Upload once here (window 0's context); every window samples the shared texture
+		uint64_t uploadStart = ofGetElapsedTimeMicros();
+		{
+			PERF_SCOPE(PERF_UPLOAD);
+			webcamTexture.loadData(webcamPixels);
+			glFlush(); // Make the new contents visible to the other contexts
 		}
+		counters.webcamUploadMicros += ofGetElapsedTimeMicros() - uploadStart;
+		counters.webcamUploadBytes += webcamPixels.size();
+		counters.webcamUploads++;
 
-		// Properly convert to grayscale
-		colorImg.setFromPixels(webcam.getPixels());
-		grayImg.setFromColorImage(colorImg); // Explicit conversion
-
-		// Use haar detection - size range relative to frame
-		int minDim = std::min(webcam.getWidth(), webcam.getHeight());
-		int minSize = int(minDim * 0.20f); // ~96px for 640x480 (filter small false positives)
-		int maxSize = int(minDim * 0.95f); // ~456px for 640x480 (allow very close faces)
-		faceFinder.findHaarObjects(grayImg, minSize, minSize, maxSize, maxSize);
-
-		// Debug output every 60 frames
-		if (ofGetFrameNum() % 60 == 0) {
-			ofLogNotice() << "Raw detections: " << faceFinder.blobs.size();
-			for (size_t i = 0; i < faceFinder.blobs.size(); i++) {
-						ofLogNotice() << "  Blob " << i << " size: " << faceFinder.blobs[i].boundingRect.width
-									  << "x" << faceFinder.blobs[i].boundingRect.height;
-					}
+		// Hand every frame to the detection thread (overwrites any unprocessed frame).
+		// It runs the cascade at an adaptive rate and tracks the face in between.
+		frameCounter++;
+		faceDetector.submit(webcamPixels);
+
+		if (frameCounter >= 60) {
+			frameCounter = 0;
+			ofLogNotice() << "Detection thread: " << faceDetector.getDetectMillis() << "ms/detect, submit "
+				<< faceDetector.getSubmitMillis() << "ms - render thread saves "
+				<< faceDetector.getRenderTimeSavedMillis() << "ms per processed frame";
+			ofLogNotice() << "Detection rate: every " << faceDetector.getFrameInterval() << " webcam frames, "
+				<< int(faceDetector.getBudgetUse() * 100) << "% of " << faceDetector.getBudgetMillis() << "ms budget, "
+				<< faceDetector.getSkippedCount() << " cascade calls skipped";
+			ofLogNotice() << "Webcam ingest: " << faceDetector.getIngestBytesPerFrame() << " bytes copied/frame (was "
+				<< faceDetector.getLegacyIngestBytesPerFrame() << " via colorImg)";
+			ofLogNotice() << "Webcam upload: " << counters.webcamUploadBytes / counters.webcamUploads << " bytes, "
+				<< counters.webcamUploadMicros / counters.webcamUploads << "us per frame for " << numOutputs
+				<< " windows (was " << numOutputs << " uploads)";
 		}
-
-		updateProximity();
 	}
 
 	// Check for static image mirror behavior
-	if (videos.size() > 0) {
-		// Find which window currently has the static image
-		int currentStaticImageWindow = -1;
-		for (int i = 0; i < NUM_OUTPUTS; i++) {
-			if (windowAssignment[i] == 2) {
-				currentStaticImageWindow = i;
-				break;
-			}
-		}
-		
-		// Only run behavior if static image exists and window changed, reset timer
-		if (currentStaticImageWindow != lastStaticImageWindow) {
-			lastStaticImageWindow = currentStaticImageWindow;
-			staticImageShowTime = ofGetElapsedTimef();
-			inMirrorMode = false;
-		}
-		
-		if (currentStaticImageWindow >= 0) {
-			float elapsedSinceImageShow = ofGetElapsedTimef() - staticImageShowTime;
-			
-			if (inMirrorMode) {
-				// Check if mirror mode should end
-				if (ofGetElapsedTimef() - mirrorModeStartTime > mirrorModeDuration) {
-					// Revert to static image
-					windowAssignment[currentStaticImageWindow] = 2;
-					inMirrorMode = false;
-					staticImageShowTime = ofGetElapsedTimef();
-					ofLogNotice() << "Window " << currentStaticImageWindow << " reverted to JPEG";
-				}
-			} else {
-				// Check if we should start mirror mode
-				if (elapsedSinceImageShow > 5.0f) {
-					// Only mirror webcam (0) - video (1) must stay exclusive to one window
-					mirrorSource = 0;
-					windowAssignment[currentStaticImageWindow] = mirrorSource;
-					inMirrorMode = true;
-					mirrorModeStartTime = ofGetElapsedTimef();
-					mirrorModeDuration = ofRandom(5.0f, 10.0f);
-					ofLogNotice() << "Window " << currentStaticImageWindow << " mirroring webcam"
-						<< " for " << mirrorModeDuration << " seconds";
-				}
-			}
-		}
+	if (!videoPaths.empty()) {
+		updateMirrorMode();
 	}
 
 	// Check for time-based swapping
-	if (ofGetElapsedTimef() - lastSwapTime > swapInterval) {
-		// Randomly shuffle assignments among all 3 windows and 3 sources
-		// Each source (0=webcam, 1=video, 2=static) goes to exactly one window
-		vector<int> sources = {0, 1, 2};
-		vector<int> oldAssignment(windowAssignment, windowAssignment + NUM_OUTPUTS);
+	if (showTime() - lastSwapTime > swapInterval) {
+		// Randomly shuffle the source pool across all windows
+		vector<int> sources = buildSourcePool();
+		// Compare against the pool sources: a mirroring window is really a static one
+		vector<int> oldAssignment = windowAssignment;
+		for (int i = 0; i < numOutputs; i++) {
+			if (mirrorStates[i].inMirrorMode) {
+				oldAssignment[i] = SOURCE_STATIC;
+			}
+		}
+		int minChanges = std::min(2, numOutputs - 1);
 		
 		bool validShuffle = false;
 		int maxAttempts = 100;
@@ -239,334 +350,571 @@ void DisplayManager::update() {
 				std::swap(sources[i], sources[j]);
 			}
 			
-			// Verify no duplicates (should always be true with proper shuffle)
-			bool hasDuplicates = (sources[0] == sources[1] || sources[1] == sources[2] || sources[0] == sources[2]);
-			
 			// Check if at least 2 positions changed
 			int changes = 0;
-			for (int i = 0; i < NUM_OUTPUTS; i++) {
+			for (int i = 0; i < numOutputs; i++) {
 				if (sources[i] != oldAssignment[i]) {
 					changes++;
 				}
 			}
 			
-			if (!hasDuplicates && changes >= 2) {
+			if (changes >= minChanges) {
 				validShuffle = true;
 			}
 		}
 		
 		// Only apply if we got a valid shuffle
 		if (validShuffle) {
-			for (int i = 0; i < NUM_OUTPUTS; i++) {
+			string log;
+			for (int i = 0; i < numOutputs; i++) {
+				// Windows that changed pool source drop any mirror mode and restart their static image timer
+				if (sources[i] != oldAssignment[i]) {
+					mirrorStates[i] = MirrorState();
+					mirrorStates[i].staticImageShowTime = showTime();
+				}
 				windowAssignment[i] = sources[i];
+				log += (i > 0 ? ", window " : "window ") + ofToString(i) + "=" + ofToString(sources[i]);
 			}
-			ofLogNotice() << "Swapped assignments: window 0=" << windowAssignment[0] 
-				<< ", window 1=" << windowAssignment[1] 
-				<< ", window 2=" << windowAssignment[2];
+			ofLogNotice() << "Swapped assignments: " << log;
 		}
 		
-		lastSwapTime = ofGetElapsedTimef();
+		lastSwapTime = showTime();
 		swapInterval = ofRandom(1.0f, 30.0f);
 	}
+
+#if GPU_TIMER_QUERIES
+	if (ofGetElapsedTimef() - lastGpuReportTime > GPU_REPORT_INTERVAL) {
+		reportGpuTimes();
+		lastGpuReportTime = ofGetElapsedTimef();
+	}
+#endif
+
+	publishFrameState();
+}
+
+void DisplayManager::publishFrameState() {
+	// Copy into the back slot (vectors keep their capacity, so this doesn't allocate)
+	FrameState& state = frameStates.back();
+	state.frameNumber = ++frameStateNumber;
+	state.time = ofGetElapsedTimef();
+	state.windowAssignment = windowAssignment;
+	state.proximity = faceDetector.getProximity();
+	state.faces = faceDetector.getResult().faces;
+	state.webcamWidth = webcam->getWidth();
+	state.webcamHeight = webcam->getHeight();
+	state.hasVideo = hasValidVideoPixels && videoTexture.isAllocated();
+	state.videoWidth = videoTexture.getWidth();
+	state.videoHeight = videoTexture.getHeight();
+	state.currentVideoIndex = currentVideoIndex;
+	frameStates.publish();
+}
+
+vector<int> DisplayManager::buildSourcePool() const {
+	// Each source at least once; video stays exclusive to one window (one clip, one decode)
+	vector<int> pool = { SOURCE_WEBCAM, SOURCE_VIDEO, SOURCE_STATIC };
+
+	// Extra windows duplicate the webcam and static image, which sample shared textures
+	for (int i = (int)pool.size(); i < numOutputs; i++) {
+		pool.push_back(i % 2 == 0 ? SOURCE_STATIC : SOURCE_WEBCAM);
+	}
+	pool.resize(numOutputs);
+	return pool;
+}
+
+void DisplayManager::updateMirrorMode() {
+	float now = showTime();
+
+	for (int i = 0; i < numOutputs; i++) {
+		MirrorState& state = mirrorStates[i];
+
+		if (state.inMirrorMode) {
+			// Check if mirror mode should end
+			if (now - state.mirrorModeStartTime > state.mirrorModeDuration) {
+				// Revert to static image
+				windowAssignment[i] = SOURCE_STATIC;
+				state.inMirrorMode = false;
+				state.staticImageShowTime = now;
+				ofLogNotice() << "Window " << i << " reverted to JPEG";
+			}
+		} else if (windowAssignment[i] == SOURCE_STATIC) {
+			// Check if we should start mirror mode
+			if (now - state.staticImageShowTime > 5.0f) {
+				// Only mirror webcam (0) - video (1) must stay exclusive to one window
+				windowAssignment[i] = SOURCE_WEBCAM;
+				state.inMirrorMode = true;
+				state.mirrorModeStartTime = now;
+				state.mirrorModeDuration = ofRandom(5.0f, 10.0f);
+				ofLogNotice() << "Window " << i << " mirroring webcam"
+					<< " for " << state.mirrorModeDuration << " seconds";
+			}
+		}
+	}
 }
 
 void DisplayManager::draw(int windowIndex) {
 	ofBackground(0);
 
-	// Load shader for this window's GL context (only once)
-	if (!glitchShaders[windowIndex].isLoaded()) {
-		if (glitchShaders[windowIndex].load("shaders/glitch")) {
-			ofLogNotice() << "Loaded shader for window " << windowIndex;
-		}
+	// Window 0 draws first each frame and latches the newest snapshot for all outputs
+	if (windowIndex == 0) {
+		frameStates.update();
+		updateResolution(frameStates.front());
+#if SINGLE_CONTEXT_COMPOSITOR
+		composeOutputs(frameStates.front());
+#endif
 	}
 
-	// Allocate FBO at fixed render resolution (scales up to fullscreen for performance)
-	if (!renderFbos[windowIndex].isAllocated()) {
-		renderFbos[windowIndex].allocate(RENDER_WIDTH, RENDER_HEIGHT, GL_RGBA);
-		ofLogNotice() << "Allocated FBO for window " << windowIndex << ": " << RENDER_WIDTH << "x" << RENDER_HEIGHT << " (renders to " << ofGetWidth() << "x" << ofGetHeight() << ")";
+	const FrameState& state = frameStates.front();
+	if (windowIndex >= (int)state.windowAssignment.size()) {
+		return; // Nothing published yet
 	}
 
-	// Update webcam texture for this GL context only when new frame
-	if (webcam.isInitialized() && webcam.isFrameNew() && webcam.getPixels().size() > 0) {
-		webcamTextures[windowIndex].loadData(webcam.getPixels());
+#if SINGLE_CONTEXT_COMPOSITOR
+	drawComposited(windowIndex, state);
+#else
+	drawPerWindow(windowIndex, state);
+#endif
+
+#if GPU_TIMER_QUERIES
+	gpuTimers[windowIndex].endFrame();
+#endif
+}
+
+void DisplayManager::updateResolution(const FrameState& state) {
+#if !SINGLE_CONTEXT_COMPOSITOR
+	// Caps follow each window's content: the webcam gains nothing past the render size,
+	// static images fill the window and video needs no more than the clip's own size
+	for (int i = 0; i < numOutputs && i < (int)state.windowAssignment.size(); i++) {
+		int assignment = state.windowAssignment[i];
+		int cap = defaultLevel;
+		if (assignment == SOURCE_STATIC) {
+			cap = windowLevelCaps[i];
+		} else if (assignment == SOURCE_VIDEO && state.hasVideo) {
+			cap = std::min(windowLevelCaps[i], ResolutionController::levelFor(state.videoWidth, state.videoHeight));
+		}
+		resolution.setMaxLevel(i, cap);
 	}
+#endif
+	// Video and static images are blitted from their native textures in compositor mode
 
-	// Draw to FBO
-	renderFbos[windowIndex].begin();
-	ofClear(0, 0, 0, 255);
+	if (!resolution.isEnabled()) {
+		return;
+	}
 
-	// Draw assigned content: 0=webcam, 1=video, 2=static image
-	ofSetColor(255);
-	int assignment = windowAssignment[windowIndex];
+	// GPU time of every window's last read-back frame. A frame whose queries
+	// haven't all landed isn't free, just unmeasured: skip it rather than read
+	// it as headroom.
+	double gpuMicros = 0.0;
+	for (auto & timer : gpuTimers) {
+		if (!timer.hasLastFrame()) {
+			return;
+		}
+		gpuMicros += timer.getLastFrameMicros();
+	}
+	int changed = resolution.update(gpuMicros / 1000.0);
+	if (changed >= 0) {
+		const RenderSize& size = resolution.getSize(changed);
+		ofLogNotice() << "Render size for " << (SINGLE_CONTEXT_COMPOSITOR ? "webcam composition" : "window " + ofToString(changed))
+			<< ": " << size.width << "x" << size.height << " (GPU " << resolution.getSmoothedMillis() << "ms, budget "
+			<< resolution.getBudgetMillis() << "ms)";
+	}
+}
 
-	if (assignment == 0) {
-		// Draw webcam fullscreen (no letterboxing)
-		webcamTextures[windowIndex].draw(0, 0, renderFbos[windowIndex].getWidth(), renderFbos[windowIndex].getHeight());
-	} else if (assignment == 1) {
-		// Draw video fullscreen to FBO using cached pixels (avoids GL context issues)
-		if (videos.size() > 0 && currentVideoIndex < videos.size()) {
-			ofVideoPlayer& video = videos[currentVideoIndex];
-			
-			// Make sure video is playing
-			if (!video.isPlaying()) {
-				video.play();
-			}
-			
-			// Copy cached pixels to window-specific texture
-			if (hasValidVideoPixels && cachedVideoPixels.isAllocated()) {
-				bool needsCopy = !videoTextures[windowIndex].isAllocated() ||
-				                 lastCopiedVideoFrame[windowIndex] != videoFrameNumber;
-				if (needsCopy) {
-					videoTextures[windowIndex].loadData(cachedVideoPixels);
-					lastCopiedVideoFrame[windowIndex] = videoFrameNumber;
-				}
-			}
-			
-			// Draw the window-specific texture
-			if (videoTextures[windowIndex].isAllocated()) {
-				videoTextures[windowIndex].draw(0, 0, renderFbos[windowIndex].getWidth(), renderFbos[windowIndex].getHeight());
-			}
+void DisplayManager::reportGpuTimes() {
+	// Per window: every phase and source it drew since the last report
+	static const char* sourceNames[] = { "webcam", "video", "static" };
+	const int numSources = SOURCE_STATIC + 1;
+	double totalMicros[GPU_NUM_PHASES][numSources] = {};
+	uint64_t totalCount[GPU_NUM_PHASES][numSources] = {};
+	for (int i = 0; i < numOutputs; i++) {
+		GpuTimer& timer = gpuTimers[i];
+		if (!timer.isSupported()) {
+			continue;
 		}
-	} else if (assignment == 2) {
-		// Draw static image fullscreen to FBO
-		// Load texture on-demand in this GL context
-		if (staticImage.isAllocated() && !staticImageTextures[windowIndex].isAllocated()) {
-			staticImageTextures[windowIndex].loadData(staticImage.getPixels());
-			ofLogNotice() << "Window " << windowIndex << " - loaded static image texture: " 
-				<< staticImageTextures[windowIndex].getWidth() << "x" << staticImageTextures[windowIndex].getHeight();
+
+		string line;
+		for (int source = 0; source < numSources; source++) {
+			for (int phase = 0; phase < GPU_NUM_PHASES; phase++) {
+				const FrameStats& stats = timer.getStats(GpuPhase(phase), source);
+				if (stats.count == 0) continue;
+				totalMicros[phase][source] += stats.mean * stats.count;
+				totalCount[phase][source] += stats.count;
+				line += string(line.empty() ? "" : ", ") + sourceNames[source] + " " + GpuTimer::phaseName(GpuPhase(phase))
+					+ " " + ofToString(stats.mean / 1000.0, 3) + "ms (max " + ofToString(stats.maximum / 1000.0, 3) + ")";
+			}
 		}
-		
-		if (staticImageTextures[windowIndex].isAllocated()) {
-			staticImageTextures[windowIndex].draw(0, 0, renderFbos[windowIndex].getWidth(), renderFbos[windowIndex].getHeight());
+		if (!line.empty()) {
+#if !SINGLE_CONTEXT_COMPOSITOR
+			line += " at " + ofToString(resolution.getSize(i).width) + "x" + ofToString(resolution.getSize(i).height);
+#endif
+			ofLogNotice() << "GPU window " << i << ": " << line
+				<< (timer.getUnavailableCount() > 0 ? " - " + ofToString(timer.getUnavailableCount()) + " results late" : "");
 		}
+		timer.resetStats();
 	}
 
-	// Draw overlays only for webcam
-	if (assignment == 0) {
-		// Calculate scale for overlays
-		float sx = (float)renderFbos[windowIndex].getWidth() / webcam.getWidth();
-		float sy = (float)renderFbos[windowIndex].getHeight() / webcam.getHeight();
-
-		// Draw face detection rectangles
-		ofSetLineWidth(2);
-		int minDim = std::min(webcam.getWidth(), webcam.getHeight());
-		float minAllowedSize = minDim * 0.20f;
+	// Per source: work at the render FBO's resolution vs. the scale-up to each window
+	string summary;
+	for (int source = 0; source < numSources; source++) {
+		double phaseMillis[GPU_NUM_PHASES] = {};
+		bool shown = false;
+		for (int phase = 0; phase < GPU_NUM_PHASES; phase++) {
+			if (totalCount[phase][source] > 0) {
+				phaseMillis[phase] = totalMicros[phase][source] / totalCount[phase][source] / 1000.0;
+				shown = true;
+			}
+		}
+		if (!shown) continue;
+		summary += string(summary.empty() ? "" : ", ") + sourceNames[source] + " "
+			+ ofToString(phaseMillis[GPU_SCENE] + phaseMillis[GPU_GLITCH], 3) + "ms FBO + "
+			+ ofToString(phaseMillis[GPU_BLIT], 3) + "ms/window blit";
+	}
+	if (!summary.empty()) {
+#if SINGLE_CONTEXT_COMPOSITOR
+		summary += " - webcam FBO " + ofToString(resolution.getSize(0).width) + "x" + ofToString(resolution.getSize(0).height);
+#endif
+		ofLogNotice() << "GPU per source: " << summary;
+	}
+}
 
-		for (size_t i = 0; i < faceFinder.blobs.size(); i++) {
-			auto & rect = faceFinder.blobs[i].boundingRect;
+void DisplayManager::drawPerWindow(int windowIndex, const FrameState& state) {
+	// Load shader for this window's GL context (only once)
+	if (!glitchShaders[windowIndex].isLoaded()) {
+		if (glitchShaders[windowIndex].load("shaders/glitch")) {
+			ofLogNotice() << "Loaded shader for window " << windowIndex;
+		}
+	}
 
-			// Filter: size check
-			if (rect.width < minAllowedSize) continue;
+	// Allocate every pool size this window can use up front (scales up to fullscreen for performance),
+	// so resolution changes never allocate mid-show
+	vector<ofFbo>& fbos = renderFbos[windowIndex];
+	if (fbos.empty()) {
+		windowLevelCaps[windowIndex] = ResolutionController::levelFor(ofGetWidth(), ofGetHeight());
+		fbos.resize(std::max(windowLevelCaps[windowIndex], defaultLevel) + 1);
+		for (int level = 0; level < (int)fbos.size(); level++) {
+			const RenderSize& size = ResolutionController::sizes[level];
+			fbos[level].allocate(size.width, size.height, GL_RGBA);
+		}
+		const RenderSize& largest = ResolutionController::sizes[fbos.size() - 1];
+		ofLogNotice() << "Allocated " << fbos.size() << " FBOs for window " << windowIndex << ": up to "
+			<< largest.width << "x" << largest.height << " (renders to " << ofGetWidth() << "x" << ofGetHeight() << ")";
+	}
+	ofFbo& fbo = fbos[std::min(resolution.getLevel(windowIndex), (int)fbos.size() - 1)];
 
-			// Filter: aspect ratio for partial/angled faces
-			float aspect = (float)rect.width / rect.height;
-			bool validAspect = (aspect >= 0.65f && aspect <= 1.55f);
+	// Draw assigned content: 0=webcam, 1=video, 2=static image
+	int assignment = state.windowAssignment[windowIndex];
 
-			if (!validAspect) continue;
+	// Draw to FBO
+	{
+		PERF_SCOPE(PERF_FBO_RENDER);
+		GPU_SCOPE(windowIndex, GPU_SCENE, assignment);
+		fbo.begin();
+		ofClear(0, 0, 0, 255);
+		ofSetColor(255);
+
+		if (assignment == 0) {
+			// Draw webcam fullscreen (no letterboxing)
+			if (webcamTexture.isAllocated()) {
+				webcamTexture.draw(0, 0, fbo.getWidth(), fbo.getHeight());
+			}
+		} else if (assignment == 1) {
+			// Draw video fullscreen to FBO from the shared texture uploaded in update()
+			if (state.hasVideo) {
+				videoTexture.draw(0, 0, fbo.getWidth(), fbo.getHeight());
+			}
+		} else if (assignment == 2) {
+			// Draw static image fullscreen to FBO from the shared texture uploaded in setup()
+			if (staticImageTexture.isAllocated()) {
+				staticImageTexture.draw(0, 0, fbo.getWidth(), fbo.getHeight());
+			}
+		}
 
-			ofSetColor(0, 255, 0);
-			ofNoFill();
-			ofPushMatrix();
-			ofScale(sx, sy);
-			ofDrawRectangle(rect);
-			ofPopMatrix();
-			ofFill();
+		// Draw overlays only for webcam
+		if (assignment == 0) {
+			drawFaceOverlay(state, fbo.getWidth(), fbo.getHeight());
 		}
-		ofSetLineWidth(1);
-	}
 
-	renderFbos[windowIndex].end();
+		fbo.end();
+	}
 
 	// Apply glitch shader only to webcam
 	ofSetColor(255);
 	if (assignment == 0 && glitchShaders[windowIndex].isLoaded()) {
-		float glitchIntensity = proximity * 2.0f;
-
-		glitchShaders[windowIndex].begin();
-		glitchShaders[windowIndex].setUniformTexture("tex0", renderFbos[windowIndex].getTexture(), 0);
-		glitchShaders[windowIndex].setUniform1f("intensity", glitchIntensity);
-		glitchShaders[windowIndex].setUniform1f("time", ofGetElapsedTimef());
-		renderFbos[windowIndex].draw(0, 0, ofGetWidth(), ofGetHeight());
-		glitchShaders[windowIndex].end();
+		float glitchIntensity = state.proximity * 2.0f;
+
+		{
+			PERF_SCOPE(PERF_SHADER);
+			GPU_SCOPE(windowIndex, GPU_GLITCH, assignment);
+			glitchShaders[windowIndex].begin();
+			glitchShaders[windowIndex].setUniformTexture("tex0", fbo.getTexture(), 0);
+			glitchShaders[windowIndex].setUniform1f("intensity", glitchIntensity);
+			glitchShaders[windowIndex].setUniform1f("time", state.time);
+			fbo.draw(0, 0, ofGetWidth(), ofGetHeight());
+			glitchShaders[windowIndex].end();
+		}
 	} else if (assignment == 1) {
 		// Draw video letterboxed to fit window
-		if (videos.size() > 0 && currentVideoIndex >= 0 && currentVideoIndex < videos.size()) {
-			float videoW = videos[currentVideoIndex].getWidth();
-			float videoH = videos[currentVideoIndex].getHeight();
-			float windowW = ofGetWidth();
-			float windowH = ofGetHeight();
-			
-			if (videoW > 0 && videoH > 0) {
-				float videoAspect = videoW / videoH;
-				float windowAspect = windowW / windowH;
-				float drawW, drawH, drawX, drawY;
-				
-				if (videoAspect > windowAspect) {
-					// Video is wider - fit to width
-					drawW = windowW;
-					drawH = windowW / videoAspect;
-					drawX = 0;
-					drawY = (windowH - drawH) * 0.5f;
-				} else {
-					// Video is taller - fit to height
-					drawH = windowH;
-					drawW = windowH * videoAspect;
-					drawX = (windowW - drawW) * 0.5f;
-					drawY = 0;
-				}
-				
-				renderFbos[windowIndex].draw(drawX, drawY, drawW, drawH);
-			} else {
-				renderFbos[windowIndex].draw(0, 0, windowW, windowH);
-			}
+		PERF_SCOPE(PERF_GL_DRAW);
+		GPU_SCOPE(windowIndex, GPU_BLIT, assignment);
+		if (state.hasVideo) {
+			fbo.draw(letterbox(state.videoWidth, state.videoHeight));
 		} else {
-			renderFbos[windowIndex].draw(0, 0, ofGetWidth(), ofGetHeight());
+			fbo.draw(0, 0, ofGetWidth(), ofGetHeight());
 		}
-	} else if (assignment == 2) {
-		// Draw static image fullscreen (no letterboxing)
-		renderFbos[windowIndex].draw(0, 0, ofGetWidth(), ofGetHeight());
 	} else {
-		renderFbos[windowIndex].draw(0, 0, ofGetWidth(), ofGetHeight());
+		// Draw static image fullscreen (no letterboxing)
+		PERF_SCOPE(PERF_GL_DRAW);
+		GPU_SCOPE(windowIndex, GPU_BLIT, assignment);
+		fbo.draw(0, 0, ofGetWidth(), ofGetHeight());
 	}
 }
 
-void DisplayManager::updateProximity() {
-	float targetProximity = proximity;
-
-	if (faceFinder.blobs.size() > 0) {
-		consecutiveDetections++;
+void DisplayManager::composeOutputs(const FrameState& state) {
+	// Runs in window 0's context before its draw. Outputs showing the same source
+	// show the same image, so each source is composed at most once per frame.
+	bool webcamShown = false;
+	for (int source : state.windowAssignment) {
+		webcamShown = webcamShown || source == SOURCE_WEBCAM;
+	}
+	if (!webcamShown || !webcamTexture.isAllocated()) {
+		return;
+	}
 
-		// Only update proximity if we've seen face consistently
-		if (consecutiveDetections >= detectionThreshold) {
-			// Use largest valid detection (most likely real face)
-			int minDim = std::min(webcam.getWidth(), webcam.getHeight());
-			float minAllowedSize = minDim * 0.20f;
-			float largestFaceSize = 0;
+	if (!glitchShader.isLoaded()) {
+		if (glitchShader.load("shaders/glitch")) {
+			ofLogNotice() << "Loaded compositor shader";
+		}
+	}
+	// Every pool size up to the render size, so resolution changes never allocate mid-show
+	if (webcamSceneFbos.empty()) {
+		webcamSceneFbos.resize(defaultLevel + 1);
+		webcamOutputFbos.resize(defaultLevel + 1);
+		for (int level = 0; level <= defaultLevel; level++) {
+			const RenderSize& size = ResolutionController::sizes[level];
+			webcamSceneFbos[level].allocate(size.width, size.height, GL_RGBA);
+			webcamOutputFbos[level].allocate(size.width, size.height, GL_RGBA);
+		}
+		ofLogNotice() << "Allocated compositor FBOs: " << webcamSceneFbos.size() << " sizes up to " << RENDER_WIDTH << "x" << RENDER_HEIGHT;
+	}
+	webcamLevel = std::min(resolution.getLevel(0), defaultLevel);
+	ofFbo& webcamSceneFbo = webcamSceneFbos[webcamLevel];
+	ofFbo& webcamOutputFbo = webcamOutputFbos[webcamLevel];
+	float width = webcamSceneFbo.getWidth();
+	float height = webcamSceneFbo.getHeight();
+
+	// Webcam and face rectangles
+	{
+		PERF_SCOPE(PERF_FBO_RENDER);
+		GPU_SCOPE(0, GPU_SCENE, SOURCE_WEBCAM);
+		webcamSceneFbo.begin();
+		ofClear(0, 0, 0, 255);
+		ofSetColor(255);
+		webcamTexture.draw(0, 0, width, height);
+		drawFaceOverlay(state, width, height);
+		webcamSceneFbo.end();
+	}
 
-			for (size_t i = 0; i < faceFinder.blobs.size(); i++) {
-				auto & rect = faceFinder.blobs[i].boundingRect;
+	// Glitch pass into the texture every webcam window samples
+	{
+		PERF_SCOPE(PERF_SHADER);
+		GPU_SCOPE(0, GPU_GLITCH, SOURCE_WEBCAM);
+		webcamOutputFbo.begin();
+		ofClear(0, 0, 0, 255);
+		ofSetColor(255);
+		if (glitchShader.isLoaded()) {
+			glitchShader.begin();
+			glitchShader.setUniformTexture("tex0", webcamSceneFbo.getTexture(), 0);
+			glitchShader.setUniform1f("intensity", state.proximity * 2.0f);
+			glitchShader.setUniform1f("time", state.time);
+			webcamSceneFbo.draw(0, 0);
+			glitchShader.end();
+		} else {
+			webcamSceneFbo.draw(0, 0);
+		}
+		webcamOutputFbo.end();
+	}
 
-				// Apply same filters as drawing
-				if (rect.width < minAllowedSize) continue;
-				float aspect = (float)rect.width / rect.height;
-				if (aspect < 0.65f || aspect > 1.55f) continue;
+	glFlush(); // Make the composed texture visible to the other contexts
+}
 
-				largestFaceSize = std::max(largestFaceSize, (float)rect.width);
-			}
+void DisplayManager::drawComposited(int windowIndex, const FrameState& state) {
+	// Each window only blits its source's shared texture - no per-window GL resources
+	int assignment = state.windowAssignment[windowIndex];
+	PERF_SCOPE(PERF_GL_DRAW);
+	GPU_SCOPE(windowIndex, GPU_BLIT, assignment);
+	ofSetColor(255);
 
-			// Only update if we found a valid face
-			if (largestFaceSize > 0) {
-				float minDetectionSize = minDim * 0.20f;
-				float maxDetectionSize = minDim * 0.95f;
-				targetProximity = ofMap(largestFaceSize, minDetectionSize, maxDetectionSize, 0.0f, 1.0f, true);
-			}
+	if (assignment == SOURCE_WEBCAM) {
+		if (!webcamOutputFbos.empty()) {
+			webcamOutputFbos[webcamLevel].getTexture().draw(0, 0, ofGetWidth(), ofGetHeight());
+		}
+	} else if (assignment == SOURCE_VIDEO) {
+		if (state.hasVideo) {
+			videoTexture.draw(letterbox(state.videoWidth, state.videoHeight));
+		}
+	} else if (assignment == SOURCE_STATIC) {
+		if (staticImageTexture.isAllocated()) {
+			staticImageTexture.draw(0, 0, ofGetWidth(), ofGetHeight());
 		}
-	} else {
-		consecutiveDetections = 0; // Reset counter
-		targetProximity *= 0.92f; // Decay slightly faster
 	}
-
-	// Smooth proximity changes to reduce jitter
-	proximity = ofLerp(proximity, targetProximity, 0.15f);
 }
 
-void DisplayManager::calculateLetterboxDims(int videoIndex) {
-	if (videoIndex < 0 || videoIndex >= (int)videos.size()) {
-		return;
-	}
+void DisplayManager::drawFaceOverlay(const FrameState& state, float width, float height) {
+	// Calculate scale for overlays
+	float sx = width / state.webcamWidth;
+	float sy = height / state.webcamHeight;
 
-	// Ensure vector is large enough
-	if (videoIndex >= (int)videoLetterboxDims.size()) {
-		videoLetterboxDims.resize(videoIndex + 1, ofVec2f(0, 0));
-	}
+	// Draw face detection rectangles
+	ofSetLineWidth(2);
+	float minDim = std::min(state.webcamWidth, state.webcamHeight);
+	float minAllowedSize = minDim * 0.20f;
 
-	// Safety check - make sure video is loaded
-	if (!videos[videoIndex].isLoaded()) {
-		ofLogWarning() << "Video " << videoIndex << " not loaded yet";
-		videoLetterboxDims[videoIndex] = ofVec2f(0, 0);
-		return;
-	}
+	const vector<ofRectangle>& faces = state.faces;
+	for (size_t i = 0; i < faces.size(); i++) {
+		auto & rect = faces[i];
 
-	float videoW = videos[videoIndex].getWidth();
-	float videoH = videos[videoIndex].getHeight();
+		// Filter: size check
+		if (rect.width < minAllowedSize) continue;
 
-	if (videoW <= 0 || videoH <= 0) {
-		ofLogWarning() << "Video " << videoIndex << " has invalid dimensions: " << videoW << "x" << videoH;
-		videoLetterboxDims[videoIndex] = ofVec2f(0, 0);
-		return;
-	}
+		// Filter: aspect ratio for partial/angled faces
+		float aspect = (float)rect.width / rect.height;
+		bool validAspect = (aspect >= 0.65f && aspect <= 1.55f);
+
+		if (!validAspect) continue;
 
-	// Target frame: 4:3 aspect ratio (720x540 for width=720)
-	float frameW = 720.0f;
-	float frameH = 540.0f; // 4:3 aspect ratio
-	float frameAspect = frameW / frameH;
+		ofSetColor(0, 255, 0);
+		ofNoFill();
+		ofPushMatrix();
+		ofScale(sx, sy);
+		ofDrawRectangle(rect);
+		ofPopMatrix();
+		ofFill();
+	}
+	ofSetLineWidth(1);
+	ofSetColor(255);
+}
 
-	float videoAspect = videoW / videoH;
-	float drawW, drawH;
+ofRectangle DisplayManager::letterbox(float contentW, float contentH) const {
+	float windowW = ofGetWidth();
+	float windowH = ofGetHeight();
+	if (contentW <= 0 || contentH <= 0) {
+		return ofRectangle(0, 0, windowW, windowH);
+	}
 
-	// If video is wider than frame, scale to fill width
-	if (videoAspect > frameAspect) {
-		drawW = frameW;
-		drawH = frameW / videoAspect;
-	} else {
-		// Otherwise scale to fill height
-		drawH = frameH;
-		drawW = frameH * videoAspect;
+	float contentAspect = contentW / contentH;
+	float windowAspect = windowW / windowH;
+	if (contentAspect > windowAspect) {
+		// Content is wider - fit to width
+		float drawH = windowW / contentAspect;
+		return ofRectangle(0, (windowH - drawH) * 0.5f, windowW, drawH);
 	}
+	// Content is taller - fit to height
+	float drawW = windowH * contentAspect;
+	return ofRectangle((windowW - drawW) * 0.5f, 0, drawW, windowH);
+}
 
-	// Center vertically
-	float drawY = (frameH - drawH) * 0.5f;
+void DisplayManager::uploadVideoFrame(const ofPixels& pixels) {
+	// (Re)allocate the shared texture when the clip's size or format changes
+	int glInternalFormat = ofGetGLInternalFormat(pixels);
+	if (!videoTexture.isAllocated() || videoTexture.getWidth() != pixels.getWidth() ||
+	    videoTexture.getHeight() != pixels.getHeight() ||
+	    videoTexture.getTextureData().glInternalFormat != glInternalFormat) {
+		videoTexture.allocate(pixels.getWidth(), pixels.getHeight(), glInternalFormat);
+	}
 
-	videoLetterboxDims[videoIndex] = ofVec2f(drawW, drawY);
+#if VIDEO_PBO_STREAMING
+	// The decoder always delivers packed RGB, so every frame goes through the PBO ring
+	ofBufferObject& pbo = videoPbos[videoPboIndex];
+	videoPboIndex = (videoPboIndex + 1) % NUM_VIDEO_PBOS;
+
+	// Orphan the buffer before mapping it: the driver hands back fresh storage
+	// while a transfer still reading the old one finishes, so the map doesn't wait
+	size_t bytes = pixels.getTotalBytes();
+	pbo.setData(bytes, nullptr, GL_STREAM_DRAW);
+
+	unsigned char* dst = pbo.map<unsigned char>(GL_WRITE_ONLY);
+	if (dst) {
+		memcpy(dst, pixels.getData(), bytes);
+		pbo.unmap();
+		// Returns immediately - the driver DMAs from the PBO while we carry on
+		videoTexture.loadData(pbo, ofGetGLFormat(pixels), GL_UNSIGNED_BYTE);
+		return;
+	}
+#endif
 
-	ofLogNotice() << "Letterbox dims for video " << videoIndex 
-		<< ": videoAspect=" << videoAspect 
-		<< ", drawW=" << drawW 
-		<< ", drawH=" << drawH 
-		<< ", drawY=" << drawY;
+	videoTexture.loadData(pixels);
 }
 
-void DisplayManager::reloadVideo(int videoIndex) {
-	if (videoIndex < 0 || videoIndex >= (int)videos.size()) {
+void DisplayManager::startVideo(int videoIndex) {
+	if (videoIndex < 0 || videoIndex >= (int)videoPaths.size()) {
 		return;
 	}
 
-	ofVideoPlayer& video = videos[videoIndex];
+	videoDecoder = make_unique<VideoDecoder>();
+	ofAddListener(videoDecoder->clipEnded, this, &DisplayManager::onClipEnded);
+	videoDecoder->start(videoPaths[videoIndex]);
+	ofLogNotice() << "Started video " << videoIndex << ": " << videoPaths[videoIndex];
+}
 
-	// Close and clear the video
-	video.close();
-	hasValidVideoPixels = false;  // Invalidate cached pixels
+void DisplayManager::prerollNextVideo() {
+	if (videoPaths.empty()) {
+		return;
+	}
 
-	// Clear textures for all windows so they get reloaded
-	for (size_t i = 0; i < videoTextures.size(); i++) {
-		if (videoTextures[i].isAllocated()) {
-			videoTextures[i].clear();
+	// Open the following clip that hasn't failed to load in the background
+	// and hold its first frame. The current clip comes round again last.
+	for (size_t step = 1; step <= videoPaths.size(); step++) {
+		int index = (currentVideoIndex + step) % videoPaths.size();
+		if (!videoLoadFailed[index]) {
+			nextVideoIndex = index;
+			nextVideoDecoder = make_unique<VideoDecoder>();
+			ofAddListener(nextVideoDecoder->clipEnded, this, &DisplayManager::onClipEnded);
+			nextVideoDecoder->start(videoPaths[index], true);
+			return;
 		}
-		lastCopiedVideoFrame[i] = -1;  // Reset frame tracking
 	}
+	ofLogWarning() << "No video left that loads, video windows keep the last frame";
+}
 
-	// Reload from disk
-	ofDirectory dir("movies/");
-	dir.allowExt("mov");
-	dir.allowExt("mp4");
-	dir.allowExt("avi");
-	dir.listDir();
+void DisplayManager::switchToNextVideo() {
+	// Swap at the frame boundary - the shared texture keeps the old clip's last
+	// frame until the pre-rolled first frame is uploaded, so there is no black gap
+	bool ready = nextVideoDecoder && nextVideoDecoder->isReady();
 
-	if (videoIndex < (int)dir.size()) {
-		video.setUseTexture(false);  // Keep texture disabled
-		video.setPixelFormat(OF_PIXELS_NATIVE);
-		video.load(dir.getPath(videoIndex));
-		
-		// Recalculate letterbox dimensions for reloaded video
-		if (video.isLoaded() && video.getWidth() > 0 && video.getHeight() > 0) {
-			calculateLetterboxDims(videoIndex);
+	// Keep the finished clip's decode totals (and deliver its end if it came in this frame)
+	if (videoDecoder) {
+		if (videoDecoder->hasFailed()) {
+			videoLoadFailed[currentVideoIndex] = true;
 		}
+		videoDecoder->clipEnded.drainDeferred();
+		counters.videoDecodedFrames += videoDecoder->getDecodedFrames();
+		counters.videoDecodeMicros += videoDecoder->getDecodeMicros();
+		counters.videoDroppedFrames += videoDecoder->getDroppedFrames();
+
+		// Its thread may still be closing the clip: let it finish on its own
+		// rather than join it here and stall every window
+		videoDecoder->stopThread();
+		retiredVideoDecoders.push_back(std::move(videoDecoder));
+	}
 
-		video.play();
-		ofLogNotice() << "Reloaded video " << videoIndex 
-			<< " - dims: " << video.getWidth() << "x" << video.getHeight();
-	} else {
-		ofLogWarning() << "Video index " << videoIndex << " exceeds directory size";
+	if (!nextVideoDecoder) {
+		return;  // Every clip failed to load
 	}
+	videoSwitchMicros = ofGetElapsedTimeMicros();
+	currentVideoIndex = nextVideoIndex;
+	videoDecoder = std::move(nextVideoDecoder);
+	videoDecoder->play();
+	ofLogNotice() << "Switched to video " << currentVideoIndex << (ready ? " (pre-rolled)" : " (still loading)");
+
+	prerollNextVideo();
 }
 
+void DisplayManager::reapRetiredVideoDecoders() {
+	// Only decoders whose threads are done: joining them returns right away
+	for (size_t i = 0; i < retiredVideoDecoders.size();) {
+		if (retiredVideoDecoders[i]->hasExited()) {
+			retiredVideoDecoders.erase(retiredVideoDecoders.begin() + i);
+		} else {
+			i++;
+		}
+	}
+}
@@ -1,70 +1,170 @@
 #pragma once
 
 #include "ofMain.h"
-#include "ofxOpenCv.h"
+#include "FaceDetector.h"
+#include "FrameStats.h"
+#include "VideoDecoder.h"
+#include "TripleBuffer.h"
+#include "FrameSource.h"
+#include "GpuTimer.h"
+#include "ResolutionController.h"
+
+// Everything draw() reads from one update(), published as an immutable snapshot
+struct FrameState {
+    uint64_t frameNumber = 0;
+    float time = 0.0f;
+    vector<int> windowAssignment;   // Source per window
+    float proximity = 0.0f;
+    vector<ofRectangle> faces;      // Face detections in webcam coordinates
+    float webcamWidth = 0.0f;
+    float webcamHeight = 0.0f;
+    bool hasVideo = false;          // videoTexture holds a frame of the current clip
+    float videoWidth = 0.0f;
+    float videoHeight = 0.0f;
+    int currentVideoIndex = 0;
+};
+
+// Cumulative per-stage counters (render thread), read by the benchmark
+struct PipelineCounters {
+    uint64_t webcamUploads = 0;
+    uint64_t webcamUploadBytes = 0;
+    uint64_t webcamUploadMicros = 0;
+    uint64_t videoUploads = 0;
+    uint64_t videoUploadBytes = 0;
+    uint64_t videoUploadMicros = 0;
+    uint64_t videoDecodedFrames = 0;
+    uint64_t videoDecodeMicros = 0;
+    uint64_t videoDroppedFrames = 0;
+};
 
 class DisplayManager {
 public:
+    // Content sources a window can be assigned
+    enum Source { SOURCE_WEBCAM = 0, SOURCE_VIDEO = 1, SOURCE_STATIC = 2 };
+    
+    void setNumOutputs(int count);  // Call before setup(), one output per window
+    int getNumOutputs() const { return numOutputs; }
+    void setWebcamSource(unique_ptr<FrameSource> source); // Call before setup(); default is the camera
+    void setDynamicResolution(bool enabled, float gpuBudgetMillis); // Call before setup()
+    void setFixedShowStep(float secondsPerUpdate); // Call before setup(); swaps and mirroring advance per update, not by wall clock
+    
     void setup();
+    void drainEvents();  // Main thread, once per frame: delivers events queued by the worker threads
     void update();
     void draw(int windowIndex);
     
-    float getProximity() const { return proximity; }
-    ofFbo& getFbo(int index) { return renderFbos[index]; }
+    float getProximity() const { return faceDetector.getProximity(); }
     bool isSetup() const { return setupComplete; }
     
+    // Benchmark access
+    const FaceDetector& getFaceDetector() const { return faceDetector; }
+    PipelineCounters getCounters() const;
+    
 private:
-    static const int NUM_OUTPUTS = 3;
+    int numOutputs = 3;
     
-    ofVideoGrabber webcam;
-    ofxCvHaarFinder faceFinder;
-    ofxCvColorImage colorImg;
-    ofxCvGrayscaleImage grayImg;
+    unique_ptr<FrameSource> webcam;    // Camera or recorded replay
+    FaceDetector faceDetector; // Haar detection + proximity on its own thread
     
-    vector<ofVideoPlayer> videos;
-    vector<ofVec2f> videoLetterboxDims;  // Pre-calculated letterbox dims {drawW, drawY}
+    vector<string> videoPaths;                 // Listed once at setup
+    unique_ptr<VideoDecoder> videoDecoder;     // Decodes the current clip on its own thread
+    unique_ptr<VideoDecoder> nextVideoDecoder; // Pre-rolls the following clip
+    int nextVideoIndex = 0;                    // Clip nextVideoDecoder holds
+    vector<bool> videoLoadFailed;              // Clips that failed to load are skipped from then on
+    vector<unique_ptr<VideoDecoder>> retiredVideoDecoders; // Switched out, freed once their threads have exited
+    uint64_t videoSwitchMicros;                // When the last switch happened, 0 once its first frame is shown
     ofImage staticImage;
-    vector<ofTexture> staticImageTextures;  // One per window
+    ofTexture staticImageTexture;  // Shared by all windows
     
-    float proximity;
-    int windowAssignment[NUM_OUTPUTS];
+    vector<int> windowAssignment;  // Source per window
     
     float lastSwapTime;
     float swapInterval;
 
+    // Clock for source swaps and mirror mode: wall time, or updates x a fixed step (benchmark)
+    float fixedShowStep = 0.0f;
+    uint64_t updateCount = 0;
+    float showTime() const;
+
     int currentVideoIndex;
     
-    // Static image mirror behavior
-    float staticImageShowTime;
-    bool inMirrorMode;
-    float mirrorModeStartTime;
-    float mirrorModeDuration;
-    int mirrorSource;
-    int lastStaticImageWindow;
+    // Static image mirror behavior, tracked per window
+    struct MirrorState {
+        float staticImageShowTime = 0;
+        bool inMirrorMode = false;
+        float mirrorModeStartTime = 0;
+        float mirrorModeDuration = 0;
+    };
+    vector<MirrorState> mirrorStates;
     
-    int frameSkip;
     int frameCounter;
     
-    // False positive filtering
-    int consecutiveDetections;
-    int detectionThreshold;
-    
     bool setupComplete;
     
-    void updateProximity();
-    void calculateLetterboxDims(int videoIndex);
-    void reloadVideo(int videoIndex);
+    // Upload and decode counters (one webcam upload per new frame, whatever the window count)
+    PipelineCounters counters;
     
-    vector<ofShader> glitchShaders; // One per window (GL context)
-    vector<ofFbo> renderFbos; // One per window
-    vector<ofTexture> webcamTextures; // One per window
-    vector<ofTexture> videoTextures; // One per window
+    vector<int> buildSourcePool() const;
+    void updateMirrorMode();
+    void startVideo(int videoIndex);
+    void prerollNextVideo();
+    void switchToNextVideo();
+    void reapRetiredVideoDecoders();
     
-    // Track which frame each window last copied (for multi-context video sync)
-    int videoFrameNumber;
-    vector<int> lastCopiedVideoFrame; // One per window
+    // Listeners for events raised on the detection and decode threads
+    void onPresenceChanged(FacePresence& presence);
+    void onClipEnded(const void* sender);
+    float lastEventReportTime = 0;
+    void reportEventQueues();
+    
+    vector<ofShader> glitchShaders; // One per window (GL context) - per-window mode only
+    vector<vector<ofFbo>> renderFbos; // Per window, one per pool size it can use - per-window mode only
+    
+    // Single-context compositor: window 0 composes each source once, every window blits
+    ofShader glitchShader;
+    vector<ofFbo> webcamSceneFbos;   // Webcam + face rectangles, one per pool size
+    vector<ofFbo> webcamOutputFbos;  // After the glitch pass, sampled by every webcam window
+    int webcamLevel = 0;             // Pool size composed this frame
+    ofTexture webcamTexture; // Shared by all windows (contexts share objects)
     
-    // Cached video pixels (avoid GL context issues with AVFoundation)
-    ofPixels cachedVideoPixels;
+    // Video frames stream through a ring of pixel-unpack buffers into one
+    // texture shared by all windows; the copy into a PBO is the only CPU copy
+    // and the GPU transfer overlaps with the next frame's decode
+    static const int NUM_VIDEO_PBOS = 3;
+    ofTexture videoTexture;
+    ofBufferObject videoPbos[NUM_VIDEO_PBOS];
+    int videoPboIndex;
+    int videoFrameNumber;
     bool hasValidVideoPixels;
+    
+    // Video upload cost and frame-time jitter, reported with decoder stats every 120 video frames
+    FrameStats videoUploadStats;
+    FrameStats frameTimeStats;
+    
+    // update() fills back() and publishes; window 0's draw() latches the newest
+    // snapshot once per frame and every output renders from front()
+    TripleBuffer<FrameState> frameStates;
+    uint64_t frameStateNumber = 0;
+    void publishFrameState();
+    
+    void composeOutputs(const FrameState& state);
+    void drawComposited(int windowIndex, const FrameState& state);
+    void drawPerWindow(int windowIndex, const FrameState& state);
+    void drawFaceOverlay(const FrameState& state, float width, float height);
+    ofRectangle letterbox(float contentW, float contentH) const;
+    void uploadVideoFrame(const ofPixels& pixels);
+    
+    // GPU cost of each render phase, one timer per window's context
+    vector<GpuTimer> gpuTimers;
+    float lastGpuReportTime = 0;
+    void reportGpuTimes();
+    
+    // Render FBO size per window (the webcam composition in compositor mode),
+    // chosen from preallocated sizes against the GPU time measured above
+    ResolutionController resolution;
+    bool dynamicResolution = true;
+    float resolutionBudgetMillis = 10.0f;
+    int defaultLevel = 0;           // RENDER_WIDTH x RENDER_HEIGHT, and the webcam's cap
+    vector<int> windowLevelCaps;    // Smallest size covering each window
+    void updateResolution(const FrameState& state);
 };
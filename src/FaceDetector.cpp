@@ -0,0 +1,373 @@
+#include "FaceDetector.h"
+#include "LumaConvert.h"
+#include "PerfTimers.h"
+
+FaceDetector::~FaceDetector() {
+	stop();
+}
+
+void FaceDetector::setup(const string& cascadeFile, int w, int h) {
+	width = w;
+	height = h;
+
+	ofLogNotice() << "Loading cascade: " << cascadeFile;
+	faceFinder.setup(cascadeFile);
+
+	// Optimized for low-res cameras and edge detection
+	faceFinder.setScaleHaar(1.2f); // Faster, still accurate (was 1.1)
+	faceFinder.setNeighbors(2); // Balanced sensitivity (2 = good for low-res + reduces false positives)
+
+	// CV image lives on the detection thread only - no GL texture
+	grayImg.setUseTexture(false);
+	grayImg.allocate(width, height);
+	motionGate.setup(width, height, 4); // Compare at 1/4 resolution
+
+	// Preallocate every mailbox slot so submit() never reallocates
+	for (auto & frame : frames.allSlots()) {
+		frame.luma.allocate(width, height, OF_PIXELS_GRAY);
+	}
+
+	startThread();
+	ofLogNotice() << "Face detection thread started (" << width << "x" << height << ")";
+}
+
+void FaceDetector::setCpuBudget(float millisPerFrame, int minInterval, int maxInterval) {
+	// Called from setup() before the thread starts
+	scheduler.setBudget(millisPerFrame);
+	scheduler.setIntervalRange(minInterval, maxInterval);
+	frameInterval = scheduler.getInterval();
+	budgetMillis = scheduler.getBudget();
+}
+
+void FaceDetector::setRoiTracking(bool enabled, float padding, int maxMisses, int fullScanInterval) {
+	// Called from setup() before the thread starts
+	roiEnabled = enabled;
+	roiPadding = std::max(0.0f, padding);
+	roiMaxMisses = std::max(1, maxMisses);
+	roiFullScanInterval = std::max(1, fullScanInterval);
+}
+
+void FaceDetector::setMotionGate(bool enabled, float threshold, int forcedInterval, float emptyProximityLevel) {
+	// Called from setup() before the thread starts
+	motionGateEnabled = enabled;
+	motionGate.setThreshold(threshold);
+	forcedScanInterval = std::max(1, forcedInterval);
+	emptyProximity = std::max(0.0f, emptyProximityLevel);
+}
+
+void FaceDetector::stop() {
+	if (isThreadRunning()) {
+		stopThread();
+		wakeCondition.notify_all();
+		waitForThread(false);
+	}
+}
+
+void FaceDetector::submit(const ofPixels& pixels) {
+	uint64_t start = ofGetElapsedTimeMicros();
+
+	if ((int)pixels.getWidth() != width || (int)pixels.getHeight() != height || pixels.getNumChannels() < 1) {
+		if (submittedFrames == 0) {
+			ofLogWarning() << "FaceDetector: dropping " << pixels.getWidth() << "x" << pixels.getHeight()
+				<< " frames (expected " << width << "x" << height << ")";
+		}
+		return;
+	}
+
+	// Convert straight from the capture buffer into the slot's luma plane
+	WebcamFrame& frame = frames.back();
+	size_t pixelCount = (size_t)width * height;
+	{
+		PERF_SCOPE(PERF_GRAYSCALE);
+		convertToLuma(pixels.getData(), pixels.getNumChannels(), frame.luma.getData(), pixelCount);
+	}
+	frame.frameNumber = ++submittedFrames;
+	submitBytes = pixelCount; // Luma written on the render thread
+	frames.publish();
+	wakeCondition.notify_one();
+
+	totalSubmitMicros += ofGetElapsedTimeMicros() - start;
+}
+
+bool FaceDetector::update() {
+	return results.update();
+}
+
+float FaceDetector::getSubmitMillis() const {
+	return submittedFrames > 0 ? totalSubmitMicros / 1000.0f / submittedFrames : 0.0f;
+}
+
+float FaceDetector::getDetectMillis() const {
+	uint64_t count = detectionCount.load();
+	return count > 0 ? totalDetectMicros.load() / 1000.0f / count : 0.0f;
+}
+
+size_t FaceDetector::getIngestBytesPerFrame() const {
+	// Luma written by submit() + the copy into grayImg
+	return submitBytes.load() + (size_t)width * height;
+}
+
+size_t FaceDetector::getLegacyIngestBytesPerFrame() const {
+	// RGB copy into the mailbox + RGB copy into colorImg + luma written by the conversion
+	return (size_t)width * height * (3 + 3 + 1);
+}
+
+float FaceDetector::getTrackMillis() const {
+	uint64_t count = trackedFrames.load();
+	return count > 0 ? totalTrackMicros.load() / 1000.0f / count : 0.0f;
+}
+
+float FaceDetector::getRenderTimeSavedMillis() const {
+	// Detection used to run inline on the render thread; now only submit() does
+	return getDetectMillis() - getSubmitMillis();
+}
+
+void FaceDetector::threadedFunction() {
+	PerfTimers::nameThread("face detection");
+	while (isThreadRunning()) {
+		if (!frames.update()) {
+			// Timed wait so a notify racing with the check can't stall us
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.wait_for(lock, std::chrono::milliseconds(10));
+			continue;
+		}
+		detect(frames.front());
+	}
+}
+
+void FaceDetector::detect(const WebcamFrame& frame) {
+	// Already luma - one copy into the IplImage the cascade works on
+	grayImg.setFromPixels(frame.luma);
+
+	// Compare every frame so the gate's reference stays one frame old, and
+	// remember any motion until the next cascade pass: someone who walks in
+	// and stops between two passes still counts
+	IplImage* gray = grayImg.getCvImage();
+	cv::Mat grayMat = cv::cvarrToMat(gray);
+	if (motionGate.hasMotion((const unsigned char*)gray->imageData, gray->widthStep)) {
+		motionSinceCascade = true;
+	}
+
+	// Frames since the last cascade pass, counting any the mailbox dropped
+	framesSinceCascade += frame.frameNumber - lastFrameNumber;
+	lastFrameNumber = frame.frameNumber;
+
+	if (framesSinceCascade < (uint64_t)scheduler.getInterval()) {
+		// Between detections the tracker moves the face box every frame
+		if (tracker.isTracking()) {
+			PERF_SCOPE(PERF_TRACK);
+			uint64_t start = ofGetElapsedTimeMicros();
+			if (tracker.track(grayMat)) {
+				lastFace = tracker.getFace();
+				trackProximity(lastFace);
+			}
+			totalTrackMicros += ofGetElapsedTimeMicros() - start;
+			trackedFrames++;
+			publishResult(frame.frameNumber, 0.0f, true);
+		}
+		return;
+	}
+	framesSinceCascade = 0;
+	bool motion = motionSinceCascade;
+	motionSinceCascade = false;
+
+	// Nothing moving in an empty room - skip the cascade, proximity just decays.
+	// A single missed detection doesn't make the room empty: it takes as many
+	// misses in a row as confirming a face does, with no face left to search
+	// around or track and proximity faded out.
+	bool roomEmpty = consecutiveMisses >= detectionThreshold && !hasLastFace && !tracker.isTracking()
+		&& proximity < emptyProximity;
+	if (motionGateEnabled && !motion && roomEmpty && skipsSinceScan < forcedScanInterval) {
+		skipsSinceScan++;
+		skippedDetections++;
+		faceFinder.blobs.clear();
+		updateProximity();
+		scheduler.recordSkippedDetection(consecutiveDetections);
+		frameInterval = scheduler.getInterval();
+		publishResult(frame.frameNumber, 0.0f, false);
+		return;
+	}
+	skipsSinceScan = 0;
+
+	// Search near the last face when we have one, otherwise the whole frame
+	uint64_t start = ofGetElapsedTimeMicros();
+	bool useRoi = roiEnabled && hasLastFace && detectionsSinceFullScan < roiFullScanInterval;
+	if (!useRoi || !scanRoi()) {
+		scanFullFrame();
+	}
+
+	// Remember the face to search around next time and re-anchor the tracker on it
+	ofRectangle face;
+	if (findLargestValidFace(face)) {
+		lastFace = face;
+		hasLastFace = true;
+		tracker.seed(grayMat, face);
+	} else if (!hasLastFace) {
+		tracker.reset();
+	}
+	uint64_t elapsed = ofGetElapsedTimeMicros() - start;
+
+	totalDetectMicros += elapsed;
+	uint64_t count = ++detectionCount;
+
+	// Debug output every 20 detections
+	if (count % 20 == 0) {
+		ofLogNotice() << "Raw detections: " << faceFinder.blobs.size()
+			<< " (detect " << getDetectMillis() << "ms avg, every " << scheduler.getInterval() << " frames, "
+			<< roiScans.load() << " ROI / " << fullScans.load() << " full scans, "
+			<< skippedDetections.load() << " skipped by motion gate, "
+			<< trackedFrames.load() << " tracked at " << getTrackMillis() << "ms)";
+		for (size_t i = 0; i < faceFinder.blobs.size(); i++) {
+			ofLogNotice() << "  Blob " << i << " size: " << faceFinder.blobs[i].boundingRect.width
+						  << "x" << faceFinder.blobs[i].boundingRect.height;
+		}
+	}
+
+	updateProximity();
+
+	scheduler.recordDetection(elapsed / 1000.0f, consecutiveDetections);
+	frameInterval = scheduler.getInterval();
+	budgetUse = scheduler.getBudgetUse();
+
+	publishResult(frame.frameNumber, elapsed / 1000.0f, false);
+}
+
+void FaceDetector::publishResult(uint64_t frameNumber, float detectMillis, bool tracked) {
+	FaceDetection& result = results.back();
+	result.faces.clear();
+	if (tracked && tracker.isTracking()) {
+		// Tracked frame - the tracker's box replaces the last cascade blobs
+		result.faces.push_back(tracker.getFace());
+	} else {
+		for (auto & blob : faceFinder.blobs) {
+			result.faces.push_back(blob.boundingRect);
+		}
+	}
+	result.proximity = proximity;
+	result.frameNumber = frameNumber;
+	result.detectMillis = detectMillis;
+	results.publish();
+}
+
+void FaceDetector::scanFullFrame() {
+	// Use haar detection - size range relative to frame
+	int minDim = std::min(width, height);
+	int minSize = int(minDim * 0.20f); // ~96px for 640x480 (filter small false positives)
+	int maxSize = int(minDim * 0.95f); // ~456px for 640x480 (allow very close faces)
+	{
+		PERF_SCOPE(PERF_DETECT);
+		faceFinder.findHaarObjects(grayImg, minSize, minSize, maxSize, maxSize);
+	}
+
+	fullScans++;
+	detectionsSinceFullScan = 0;
+	roiMisses = 0;
+	hasLastFace = false;
+}
+
+bool FaceDetector::scanRoi() {
+	// Padded window around the last face, clipped to the frame
+	float pad = lastFace.width * roiPadding;
+	ofRectangle roi(lastFace.x - pad, lastFace.y - pad, lastFace.width + pad * 2, lastFace.height + pad * 2);
+	roi = roi.getIntersection(ofRectangle(0, 0, width, height));
+
+	// Narrowed scale range: the face won't shrink much between detections,
+	// and the window size caps how large it can be found
+	int minDim = std::min(width, height);
+	int minSize = int(std::max(minDim * 0.20f, lastFace.width * 0.7f));
+	{
+		PERF_SCOPE(PERF_DETECT);
+		faceFinder.findHaarObjects(grayImg, roi, minSize, minSize);
+	}
+
+	roiScans++;
+	detectionsSinceFullScan++;
+
+	ofRectangle face;
+	if (findLargestValidFace(face)) {
+		roiMisses = 0;
+		return true;
+	}
+
+	// Face left the window - report the miss until we give up on it
+	roiMisses++;
+	return roiMisses < roiMaxMisses;
+}
+
+bool FaceDetector::findLargestValidFace(ofRectangle& face) const {
+	int minDim = std::min(width, height);
+	float minAllowedSize = minDim * 0.20f;
+	bool found = false;
+
+	for (size_t i = 0; i < faceFinder.blobs.size(); i++) {
+		auto & rect = faceFinder.blobs[i].boundingRect;
+
+		// Apply same filters as drawing
+		if (rect.width < minAllowedSize) continue;
+		float aspect = (float)rect.width / rect.height;
+		if (aspect < 0.65f || aspect > 1.55f) continue;
+
+		if (!found || rect.width > face.width) {
+			face = rect;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void FaceDetector::updateProximity() {
+	PERF_SCOPE(PERF_PROXIMITY);
+
+	float targetProximity = proximity;
+
+	if (faceFinder.blobs.size() > 0) {
+		consecutiveDetections++;
+		consecutiveMisses = 0;
+
+		// Only update proximity if we've seen face consistently
+		if (consecutiveDetections >= detectionThreshold) {
+			// Use largest valid detection (most likely real face)
+			ofRectangle largestFace;
+
+			// Only update if we found a valid face
+			if (findLargestValidFace(largestFace)) {
+				targetProximity = proximityForFaceSize(largestFace.width);
+			}
+		}
+	} else {
+		consecutiveDetections = 0; // Reset counter
+		consecutiveMisses++;
+		targetProximity *= 0.92f; // Decay slightly faster
+	}
+
+	// Smooth proximity changes to reduce jitter
+	proximity = ofLerp(proximity, targetProximity, 0.15f);
+
+	// Presence changes are queued for the main thread; proximity itself goes out with every result
+	bool present = consecutiveDetections >= detectionThreshold;
+	if (present != facePresent) {
+		facePresent = present;
+		FacePresence presence;
+		presence.present = present;
+		presence.proximity = proximity;
+		presenceChanged.notifyDeferred(this, presence);
+	}
+}
+
+void FaceDetector::trackProximity(const ofRectangle& trackedFace) {
+	// Only a confirmed face drives proximity, same as updateProximity()
+	if (consecutiveDetections < detectionThreshold) {
+		return;
+	}
+
+	// Measured every webcam frame, so it needs much less smoothing than
+	// the once-per-detection lerp to stay steady
+	proximity = ofLerp(proximity, proximityForFaceSize(trackedFace.width), 0.35f);
+}
+
+float FaceDetector::proximityForFaceSize(float faceSize) const {
+	int minDim = std::min(width, height);
+	float minDetectionSize = minDim * 0.20f;
+	float maxDetectionSize = minDim * 0.95f;
+	return ofMap(faceSize, minDetectionSize, maxDetectionSize, 0.0f, 1.0f, true);
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOpenCv.h"
+#include "TripleBuffer.h"
+#include "DetectionScheduler.h"
+#include "MotionGate.h"
+#include "FaceTracker.h"
+#include <condition_variable>
+
+// Result published by the detection thread
+struct FaceDetection {
+    vector<ofRectangle> faces;  // Raw Haar detections (or the tracked box) in webcam coordinates
+    float proximity = 0.0f;
+    uint64_t frameNumber = 0;   // Webcam frame the result was computed from
+    float detectMillis = 0.0f;  // Time spent in findHaarObjects
+};
+
+// A confirmed face appeared or went away
+struct FacePresence {
+    bool present = false;
+    float proximity = 0.0f;
+};
+
+// Runs Haar face detection on its own thread so the render loop never
+// waits on OpenCV. Frames go in through a single-slot mailbox (newer frames
+// overwrite older ones) and results come back through a lock-free handoff.
+// Every webcam frame is submitted: the cascade runs at the scheduler's rate
+// and a FaceTracker follows the face (and proximity) on the frames between.
+class FaceDetector : public ofThread {
+public:
+    ~FaceDetector();
+
+    void setup(const string& cascadeFile, int width, int height);
+    void stop();
+
+    // Render thread: convert the latest webcam frame to luma and hand it over, never blocks
+    void submit(const ofPixels& pixels);
+    // Render thread: pick up the newest result, returns true if it changed
+    bool update();
+
+    const FaceDetection& getResult() const { return results.front(); }
+    float getProximity() const { return results.front().proximity; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Timing: render-thread cost of submitting vs. detection moved off it
+    float getSubmitMillis() const;
+    float getDetectMillis() const;
+    float getRenderTimeSavedMillis() const;
+    float getTrackMillis() const;
+    uint64_t getTrackedFrameCount() const { return trackedFrames.load(); }
+
+    // Bytes copied per webcam frame on the way into the cascade
+    size_t getIngestBytesPerFrame() const;
+    size_t getLegacyIngestBytesPerFrame() const; // Old RGB mailbox + colorImg round trip
+    uint64_t getDetectionCount() const { return detectionCount.load(); }
+    uint64_t getDetectMicros() const { return totalDetectMicros.load(); }  // Cumulative, for benchmarking
+    uint64_t getTrackMicros() const { return totalTrackMicros.load(); }
+
+    // Adaptive detection rate (see DetectionScheduler)
+    void setCpuBudget(float millisPerFrame, int minInterval, int maxInterval);
+    int getFrameInterval() const { return frameInterval.load(); }
+    float getBudgetMillis() const { return budgetMillis.load(); }
+    float getBudgetUse() const { return budgetUse.load(); }
+
+    // Region-of-interest scanning around the last face
+    void setRoiTracking(bool enabled, float padding, int maxMisses, int fullScanInterval);
+    uint64_t getRoiScanCount() const { return roiScans.load(); }
+    uint64_t getFullScanCount() const { return fullScans.load(); }
+
+    // Motion gate: skip the cascade while an empty room stays unchanged
+    void setMotionGate(bool enabled, float threshold, int forcedScanInterval, float emptyProximity);
+    uint64_t getSkippedCount() const { return skippedDetections.load(); }
+
+    // Raised on the detection thread with notifyDeferred; listeners run on
+    // whichever thread drains it (the main thread, see DisplayManager::drainEvents)
+    ofEvent<FacePresence> presenceChanged;
+
+protected:
+    void threadedFunction() override;
+
+private:
+    struct WebcamFrame {
+        ofPixels luma;              // Grayscale, converted on submit
+        uint64_t frameNumber = 0;
+    };
+
+    void detect(const WebcamFrame& frame);
+    void publishResult(uint64_t frameNumber, float detectMillis, bool tracked);
+    void scanFullFrame();
+    bool scanRoi();
+    bool findLargestValidFace(ofRectangle& face) const;
+    void updateProximity();
+    void trackProximity(const ofRectangle& trackedFace);
+    float proximityForFaceSize(float faceSize) const;
+
+    ofxCvHaarFinder faceFinder;
+    ofxCvGrayscaleImage grayImg;
+    int width = 0;
+    int height = 0;
+
+    TripleBuffer<WebcamFrame> frames;
+    TripleBuffer<FaceDetection> results;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+
+    // Detection-thread state
+    float proximity = 0.0f;
+    int consecutiveDetections = 0;
+    int consecutiveMisses = 0;
+    int detectionThreshold = 3; // Must detect face in 3+ consecutive processed frames
+    bool facePresent = false;   // Last presence sent through presenceChanged
+    DetectionScheduler scheduler;
+
+    // ROI tracking (detection thread)
+    bool roiEnabled = true;
+    float roiPadding = 0.5f;       // Padding around the last face, in face widths
+    int roiMaxMisses = 1;          // ROI misses before falling back to a full scan
+    int roiFullScanInterval = 15;  // Force a full scan every N detections
+    bool hasLastFace = false;
+    ofRectangle lastFace;
+    int roiMisses = 0;
+    int detectionsSinceFullScan = 0;
+    std::atomic<uint64_t> roiScans{0};
+    std::atomic<uint64_t> fullScans{0};
+
+    // Motion gate (detection thread)
+    MotionGate motionGate;
+    bool motionGateEnabled = true;
+    int forcedScanInterval = 30;   // Run the cascade at least every N skips
+    float emptyProximity = 0.05f;  // Only gate once proximity has decayed below this
+    int skipsSinceScan = 0;
+    bool motionSinceCascade = false;  // Any frame moved since the last cascade decision
+    std::atomic<uint64_t> skippedDetections{0};
+
+    // Per-frame tracking between cascade passes (detection thread)
+    FaceTracker tracker;
+    uint64_t lastFrameNumber = 0;
+    uint64_t framesSinceCascade = 0;
+    std::atomic<uint64_t> trackedFrames{0};
+    std::atomic<uint64_t> totalTrackMicros{0};
+
+    // Scheduler output shared with the render thread
+    std::atomic<int> frameInterval{3};
+    std::atomic<float> budgetMillis{0.0f};
+    std::atomic<float> budgetUse{0.0f};
+
+    // Timing counters
+    uint64_t submittedFrames = 0;           // Render thread only
+    uint64_t totalSubmitMicros = 0;         // Render thread only
+    std::atomic<size_t> submitBytes{0};
+    std::atomic<uint64_t> totalDetectMicros{0};
+    std::atomic<uint64_t> detectionCount{0};
+};
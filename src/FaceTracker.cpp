@@ -0,0 +1,103 @@
+#include "FaceTracker.h"
+
+// Fewer surviving points than this and the estimate is noise
+static const size_t MIN_POINTS = 6;
+static const int MAX_POINTS = 40;
+
+void FaceTracker::seed(const cv::Mat& gray, const ofRectangle& seedFace) {
+	face = seedFace;
+	gray.copyTo(previousGray);
+	findPoints(previousGray);
+	tracking = points.size() >= MIN_POINTS;
+}
+
+void FaceTracker::reset() {
+	tracking = false;
+	points.clear();
+}
+
+bool FaceTracker::track(const cv::Mat& gray) {
+	if (!tracking) {
+		return false;
+	}
+
+	// Top up corners when too many have been dropped
+	if (points.size() < MIN_POINTS * 2) {
+		findPoints(previousGray);
+	}
+
+	cv::calcOpticalFlowPyrLK(previousGray, gray, points, nextPoints, status, errors, cv::Size(11, 11), 2);
+
+	// Keep only the points LK could follow
+	dxs.clear();
+	dys.clear();
+	size_t kept = 0;
+	for (size_t i = 0; i < points.size(); i++) {
+		if (!status[i]) continue;
+		dxs.push_back(nextPoints[i].x - points[i].x);
+		dys.push_back(nextPoints[i].y - points[i].y);
+		points[kept] = points[i];
+		nextPoints[kept] = nextPoints[i];
+		kept++;
+	}
+	points.resize(kept);
+	nextPoints.resize(kept);
+
+	if (kept < MIN_POINTS) {
+		reset();
+		return false;
+	}
+
+	// Scale from the change in spacing between point pairs half the set apart
+	scales.clear();
+	for (size_t i = 0; i < kept; i++) {
+		size_t j = (i + kept / 2) % kept;
+		float before = std::hypot(points[i].x - points[j].x, points[i].y - points[j].y);
+		float after = std::hypot(nextPoints[i].x - nextPoints[j].x, nextPoints[i].y - nextPoints[j].y);
+		if (before > 1.0f) {
+			scales.push_back(after / before);
+		}
+	}
+	float scale = scales.empty() ? 1.0f : ofClamp(median(scales), 0.8f, 1.25f);
+
+	float centerX = face.getCenterX() + median(dxs);
+	float centerY = face.getCenterY() + median(dys);
+	float w = face.width * scale;
+	float h = face.height * scale;
+	face.set(centerX - w * 0.5f, centerY - h * 0.5f, w, h);
+
+	// Lost once the box has mostly left the frame
+	ofRectangle visible = face.getIntersection(ofRectangle(0, 0, gray.cols, gray.rows));
+	if (visible.getArea() < face.getArea() * 0.5f) {
+		reset();
+		return false;
+	}
+
+	points.swap(nextPoints);
+	gray.copyTo(previousGray);
+	return true;
+}
+
+void FaceTracker::findPoints(const cv::Mat& gray) {
+	// Inner part of the box - the edges are mostly background
+	ofRectangle inner = face;
+	inner.scaleFromCenter(0.8f);
+	inner = inner.getIntersection(ofRectangle(0, 0, gray.cols, gray.rows));
+	if (inner.width < 8 || inner.height < 8) {
+		points.clear();
+		return;
+	}
+
+	cv::Rect roi(inner.x, inner.y, inner.width, inner.height);
+	cv::goodFeaturesToTrack(gray(roi), points, MAX_POINTS, 0.01, 3);
+	for (auto & p : points) {
+		p.x += roi.x;
+		p.y += roi.y;
+	}
+}
+
+float FaceTracker::median(vector<float>& values) {
+	auto middle = values.begin() + values.size() / 2;
+	std::nth_element(values.begin(), middle, values.end());
+	return *middle;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxCv.h"
+
+// Median-flow face tracker that carries the Haar box between detections.
+// Corners inside the box are followed with pyramidal Lucas-Kanade; the median
+// displacement moves the box and the median change in point spacing scales
+// it. Every cascade hit re-anchors it with seed().
+class FaceTracker {
+public:
+    void seed(const cv::Mat& gray, const ofRectangle& face);
+    bool track(const cv::Mat& gray); // Returns false once the track is lost
+    void reset();
+
+    bool isTracking() const { return tracking; }
+    const ofRectangle& getFace() const { return face; }
+
+private:
+    void findPoints(const cv::Mat& gray);
+    float median(vector<float>& values);
+
+    cv::Mat previousGray;
+    vector<cv::Point2f> points;
+    vector<cv::Point2f> nextPoints;
+    vector<unsigned char> status;
+    vector<float> errors;
+    vector<float> dxs;
+    vector<float> dys;
+    vector<float> scales;
+
+    ofRectangle face;
+    bool tracking = false;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Frame-interval histogram in 0.5ms bins up to 100ms (longer intervals land in
+// the last bin), for percentile reporting of stutter per output.
+// Call reset() after each report to measure the next window.
+struct FrameHistogram {
+    static const int NUM_BINS = 200;
+    static constexpr double BIN_MILLIS = 0.5;
+
+    std::array<uint32_t, NUM_BINS> bins{};
+    uint64_t count = 0;
+    double maximum = 0.0;
+
+    void add(double millis) {
+        int bin = std::min((int)(millis / BIN_MILLIS), NUM_BINS - 1);
+        bins[std::max(bin, 0)]++;
+        count++;
+        maximum = std::max(maximum, millis);
+    }
+
+    // Upper edge of the bin holding the given fraction (0-1) of samples
+    double percentile(double fraction) const {
+        uint64_t target = (uint64_t)(fraction * count);
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BINS; i++) {
+            seen += bins[i];
+            if (seen > target) {
+                return (i + 1) * BIN_MILLIS;
+            }
+        }
+        return maximum;
+    }
+
+    // Samples at or above the given interval (to bin resolution)
+    uint64_t countAbove(double millis) const {
+        uint64_t above = 0;
+        for (int i = std::min((int)std::ceil(millis / BIN_MILLIS), NUM_BINS - 1); i < NUM_BINS; i++) {
+            above += bins[i];
+        }
+        return above;
+    }
+
+    void reset() { *this = FrameHistogram(); }
+};
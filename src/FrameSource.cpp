@@ -0,0 +1,129 @@
+#include "FrameSource.h"
+
+// Rate used for image sequences when none is given (matches the camera)
+#define DEFAULT_REPLAY_FPS 24.0f
+
+unique_ptr<FrameSource> FrameSource::createReplay(const string& path, float fps, bool realTime, bool loop) {
+	ofDirectory dir(path);
+	if (dir.isDirectory()) {
+		return make_unique<ImageSequenceFrameSource>(path, fps > 0 ? fps : DEFAULT_REPLAY_FPS, realTime, loop);
+	}
+	return make_unique<VideoFileFrameSource>(path, fps, realTime, loop);
+}
+
+bool CameraFrameSource::setup() {
+	grabber.setDesiredFrameRate(requestedFps);
+	return grabber.setup(requestedWidth, requestedHeight);
+}
+
+void CameraFrameSource::update() {
+	grabber.update();
+	if (grabber.isFrameNew()) {
+		timestamp = ofGetElapsedTimef();
+		frameNumber = hasFrame ? frameNumber + 1 : 0;
+		hasFrame = true;
+	}
+}
+
+void ReplayFrameSource::update() {
+	frameNew = false;
+	int count = getFrameCount();
+	if (finished || count == 0) {
+		return;
+	}
+
+	// Which frame is due: the next one (fixed rate) or the one the clock has reached
+	uint64_t due;
+	if (realTime) {
+		if (!clockStarted) {
+			clockStart = ofGetElapsedTimef();
+			clockStarted = true;
+		}
+		due = (uint64_t)((ofGetElapsedTimef() - clockStart) * fps);
+	} else {
+		due = delivered ? sequence + 1 : 0;
+	}
+	if (delivered && due <= sequence) {
+		return;
+	}
+
+	if (!loop && due >= (uint64_t)count) {
+		finished = true;
+		return;
+	}
+
+	if (loadFrame(due % count)) {
+		sequence = due;
+		delivered = true;
+		frameNew = true;
+	}
+}
+
+bool VideoFileFrameSource::setup() {
+	player.setUseTexture(false);
+	player.setPixelFormat(OF_PIXELS_RGB);
+	if (!player.load(path)) {
+		ofLogError() << "Failed to load replay clip: " << path;
+		return false;
+	}
+
+	// Stepped by seeking, never played
+	player.setLoopState(OF_LOOP_NONE);
+	player.setPaused(true);
+	frameCount = player.getTotalNumFrames();
+	if (fps <= 0) {
+		fps = player.getDuration() > 0 ? frameCount / player.getDuration() : DEFAULT_REPLAY_FPS;
+	}
+	return frameCount > 0 && loadFrame(0);
+}
+
+bool VideoFileFrameSource::loadFrame(int index) {
+	player.setFrame(index);
+	player.update();
+	const ofPixels& frame = player.getPixels();
+	if (!frame.isAllocated()) {
+		return false;
+	}
+	pixels = frame;
+	return true;
+}
+
+string VideoFileFrameSource::describe() const {
+	return ofFilePath::getFileName(path) + " (" + ofToString(frameCount) + " frames at " + ofToString(fps) + "fps, "
+		+ (realTime ? "real-time" : "fixed-rate") + (loop ? ", looping)" : ")");
+}
+
+bool ImageSequenceFrameSource::setup() {
+	ofDirectory dir(directory);
+	dir.allowExt("png");
+	dir.allowExt("jpg");
+	dir.allowExt("jpeg");
+	dir.allowExt("bmp");
+	dir.listDir();
+	dir.sort();
+	for (auto & file : dir) {
+		paths.push_back(file.getAbsolutePath());
+	}
+	if (paths.empty()) {
+		ofLogError() << "No images in replay sequence: " << directory;
+		return false;
+	}
+	return loadFrame(0);
+}
+
+bool ImageSequenceFrameSource::loadFrame(int index) {
+	if (!ofLoadImage(pixels, paths[index])) {
+		ofLogError() << "Failed to load " << paths[index];
+		return false;
+	}
+	// Same layout as the camera delivers
+	if (pixels.getNumChannels() != 3) {
+		pixels.setImageType(OF_IMAGE_COLOR);
+	}
+	return true;
+}
+
+string ImageSequenceFrameSource::describe() const {
+	return directory + " (" + ofToString(paths.size()) + " images at " + ofToString(fps) + "fps, "
+		+ (realTime ? "real-time" : "fixed-rate") + (loop ? ", looping)" : ")");
+}
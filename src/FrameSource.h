@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Where webcam frames come from. DisplayManager uploads and submits
+// whatever the source delivers, so a recorded source drives exactly the
+// same texture and detection path as the live camera.
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    virtual bool setup() = 0;
+    virtual void update() = 0;
+    virtual bool isFrameNew() const = 0;
+    virtual const ofPixels& getPixels() const = 0;
+    virtual float getWidth() const = 0;
+    virtual float getHeight() const = 0;
+
+    virtual double getTimestamp() const = 0;      // Seconds, of the current frame
+    virtual uint64_t getFrameNumber() const = 0;  // Frames delivered so far - 1
+    virtual bool isFinished() const { return false; }
+    virtual string describe() const = 0;
+
+    // Video file or image-sequence directory (chosen by the path). fps <= 0
+    // takes the clip's own rate (24 for image sequences).
+    static unique_ptr<FrameSource> createReplay(const string& path, float fps, bool realTime, bool loop);
+};
+
+// The physical camera
+class CameraFrameSource : public FrameSource {
+public:
+    CameraFrameSource(int width, int height, int fps) : requestedWidth(width), requestedHeight(height), requestedFps(fps) {}
+
+    bool setup() override;
+    void update() override;
+    bool isFrameNew() const override { return grabber.isFrameNew(); }
+    const ofPixels& getPixels() const override { return grabber.getPixels(); }
+    float getWidth() const override { return grabber.getWidth(); }
+    float getHeight() const override { return grabber.getHeight(); }
+    double getTimestamp() const override { return timestamp; }
+    uint64_t getFrameNumber() const override { return frameNumber; }
+    string describe() const override { return "camera"; }
+
+private:
+    ofVideoGrabber grabber;
+    int requestedWidth;
+    int requestedHeight;
+    int requestedFps;
+    double timestamp = 0.0;
+    uint64_t frameNumber = 0;
+    bool hasFrame = false;
+};
+
+// Replays recorded frames. Frame n always has timestamp n / fps. In fixed-rate
+// mode every update() delivers the next frame, so runs are repeatable whatever
+// the render rate; in real-time mode frames follow the wall clock and late
+// ones are skipped.
+class ReplayFrameSource : public FrameSource {
+public:
+    ReplayFrameSource(float fps, bool realTime, bool loop) : fps(fps), realTime(realTime), loop(loop) {}
+
+    void update() override;
+    bool isFrameNew() const override { return frameNew; }
+    double getTimestamp() const override { return sequence / fps; }
+    uint64_t getFrameNumber() const override { return sequence; }
+    bool isFinished() const override { return finished; }
+
+protected:
+    virtual int getFrameCount() const = 0;
+    virtual bool loadFrame(int index) = 0;
+
+    float fps;
+    bool realTime;
+    bool loop;
+
+private:
+    uint64_t sequence = 0;
+    bool delivered = false;
+    bool frameNew = false;
+    bool finished = false;
+    bool clockStarted = false;
+    float clockStart = 0.0f;
+};
+
+// Replays a video file by seeking frame by frame
+class VideoFileFrameSource : public ReplayFrameSource {
+public:
+    VideoFileFrameSource(const string& path, float fps, bool realTime, bool loop)
+        : ReplayFrameSource(fps, realTime, loop), path(path) {}
+
+    bool setup() override;
+    const ofPixels& getPixels() const override { return pixels; }
+    float getWidth() const override { return pixels.getWidth(); }
+    float getHeight() const override { return pixels.getHeight(); }
+    string describe() const override;
+
+protected:
+    int getFrameCount() const override { return frameCount; }
+    bool loadFrame(int index) override;
+
+private:
+    string path;
+    ofVideoPlayer player;
+    ofPixels pixels;
+    int frameCount = 0;
+};
+
+// Replays a directory of numbered images (sorted by file name)
+class ImageSequenceFrameSource : public ReplayFrameSource {
+public:
+    ImageSequenceFrameSource(const string& directory, float fps, bool realTime, bool loop)
+        : ReplayFrameSource(fps, realTime, loop), directory(directory) {}
+
+    bool setup() override;
+    const ofPixels& getPixels() const override { return pixels; }
+    float getWidth() const override { return pixels.getWidth(); }
+    float getHeight() const override { return pixels.getHeight(); }
+    string describe() const override;
+
+protected:
+    int getFrameCount() const override { return (int)paths.size(); }
+    bool loadFrame(int index) override;
+
+private:
+    string directory;
+    vector<string> paths;
+    ofPixels pixels;
+};
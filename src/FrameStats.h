@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Running mean / standard deviation / max (Welford), for jitter reporting.
+// Call reset() after each report to measure the next window.
+struct FrameStats {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double maximum = 0.0;
+
+    void add(double value) {
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        maximum = std::max(maximum, value);
+    }
+
+    double stddev() const { return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0; }
+
+    void reset() { *this = FrameStats(); }
+};
@@ -0,0 +1,102 @@
+#include "GpuTimer.h"
+
+bool GpuTimer::setup() {
+	initialized = true;
+#ifdef TARGET_OPENGLES
+	supported = false;
+#else
+	arbTimerQuery = ofGLCheckExtension("GL_ARB_timer_query");
+	supported = arbTimerQuery || ofGLCheckExtension("GL_EXT_timer_query");
+#endif
+	if (!supported) {
+		ofLogWarning() << "GPU timer queries not supported by this context, GPU timing disabled";
+		return false;
+	}
+
+	// All query objects up front, in the context that will use them
+	for (auto & frame : frames) {
+		for (auto & query : frame.queries) {
+			glGenQueries(1, &query.id);
+		}
+	}
+	return true;
+}
+
+void GpuTimer::begin(GpuPhase phase, int source) {
+	if (!initialized) {
+		setup();
+	}
+	Frame& frame = frames[frameIndex];
+	if (!supported || running || frame.count >= MAX_QUERIES || source < 0 || source >= MAX_SOURCES) {
+		return;
+	}
+
+	Query& query = frame.queries[frame.count++];
+	query.phase = phase;
+	query.source = source;
+	glBeginQuery(GL_TIME_ELAPSED, query.id);
+	running = true;
+}
+
+void GpuTimer::end() {
+	if (running) {
+		glEndQuery(GL_TIME_ELAPSED);
+		running = false;
+	}
+}
+
+void GpuTimer::endFrame() {
+	if (!supported) {
+		return;
+	}
+
+	// The next slot was issued LATENCY - 1 frames ago; collect what has landed before reusing it
+	frameIndex = (frameIndex + 1) % LATENCY;
+	Frame& frame = frames[frameIndex];
+	lastFrameMicros = 0.0;
+	lastFrameComplete = frame.count > 0;
+	for (int i = 0; i < frame.count; i++) {
+		const Query& query = frame.queries[i];
+		GLint available = 0;
+		glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			double micros = readElapsed(query.id) / 1000.0;
+			stats[query.phase][query.source].add(micros);
+			lastFrameMicros += micros;
+		} else {
+			unavailable++;
+			lastFrameComplete = false;
+		}
+	}
+	frame.count = 0;
+}
+
+GLuint64 GpuTimer::readElapsed(GLuint id) const {
+	GLuint64 nanos = 0;
+#ifndef TARGET_OPENGLES
+	if (arbTimerQuery) {
+		glGetQueryObjectui64v(id, GL_QUERY_RESULT, &nanos);
+	} else {
+		glGetQueryObjectui64vEXT(id, GL_QUERY_RESULT, &nanos);
+	}
+#endif
+	return nanos;
+}
+
+void GpuTimer::resetStats() {
+	for (auto & phase : stats) {
+		for (auto & source : phase) {
+			source.reset();
+		}
+	}
+	unavailable = 0;
+}
+
+const char* GpuTimer::phaseName(GpuPhase phase) {
+	switch (phase) {
+		case GPU_SCENE: return "scene";
+		case GPU_GLITCH: return "glitch";
+		case GPU_BLIT: return "blit";
+		default: return "?";
+	}
+}
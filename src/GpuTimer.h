@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FrameStats.h"
+
+// Render phases timed on the GPU
+enum GpuPhase {
+    GPU_SCENE,      // Source (+ face overlay) into a render-resolution FBO
+    GPU_GLITCH,     // Glitch pass
+    GPU_BLIT,       // Final textured draw to the window
+    GPU_NUM_PHASES
+};
+
+// GL_TIME_ELAPSED timing for one GL context. Query objects aren't shared
+// between contexts, so each window owns one. A frame's queries are read back
+// LATENCY frames later and only if the result is already available, so timing
+// never stalls the pipeline. Time-elapsed queries can't nest: time phases one
+// after another, never inside each other.
+class GpuTimer {
+public:
+    static const int LATENCY = 4;       // Frames in flight before a result is read
+    static const int MAX_QUERIES = 8;   // Phases per frame
+    static const int MAX_SOURCES = 4;   // Content sources a phase is attributed to
+
+    // Render thread, with this timer's context current
+    void begin(GpuPhase phase, int source);
+    void end();
+    void endFrame();    // After the window's last phase: read back the oldest frame
+
+    bool isSupported() const { return supported; }
+
+    // Microseconds per phase and source since the last reset
+    const FrameStats& getStats(GpuPhase phase, int source) const { return stats[phase][source]; }
+    uint64_t getUnavailableCount() const { return unavailable; }  // Results skipped, not waited on
+    double getLastFrameMicros() const { return lastFrameMicros; } // All phases of the frame read back last
+    bool hasLastFrame() const { return lastFrameComplete; }       // Every query of that frame had landed
+    void resetStats();
+
+    static const char* phaseName(GpuPhase phase);
+
+private:
+    struct Query {
+        GLuint id = 0;
+        GpuPhase phase = GPU_SCENE;
+        int source = 0;
+    };
+    struct Frame {
+        Query queries[MAX_QUERIES];
+        int count = 0;
+    };
+
+    bool setup();
+    GLuint64 readElapsed(GLuint id) const;
+
+    Frame frames[LATENCY];
+    int frameIndex = 0;
+    bool initialized = false;
+    bool supported = false;
+    bool arbTimerQuery = false; // Otherwise EXT_timer_query (legacy macOS contexts)
+    bool running = false;
+
+    FrameStats stats[GPU_NUM_PHASES][MAX_SOURCES];
+    uint64_t unavailable = 0;
+    double lastFrameMicros = 0.0;
+    bool lastFrameComplete = false;
+};
+
+// Times the enclosing scope on the GPU
+class ScopedGpuTimer {
+public:
+    ScopedGpuTimer(GpuTimer& timer, GpuPhase phase, int source) : timer(timer) {
+        timer.begin(phase, source);
+    }
+    ~ScopedGpuTimer() {
+        timer.end();
+    }
+
+private:
+    GpuTimer& timer;
+};
@@ -0,0 +1,120 @@
+#include "LumaConvert.h"
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LUMA_SSSE3 1
+#include <tmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LUMA_TARGET_SSSE3
+#else
+#define LUMA_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+static inline uint8_t lumaOf(const uint8_t* px) {
+	return (uint8_t)((77 * px[0] + 150 * px[1] + 29 * px[2] + 128) >> 8);
+}
+
+#ifdef LUMA_SSSE3
+// x86-64 only guarantees SSE2, so the SSSE3 kernel is picked at runtime
+static bool hasSsse3() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+// 16 pixels per step: pshufb de-interleaves the 48 bytes into R, G and B,
+// which are widened to 16 bits, weighted, rounded and narrowed. Matches
+// lumaOf() exactly: 255 * 256 + 128 still fits in 16 bits.
+LUMA_TARGET_SSSE3
+static size_t convertRgbSsse3(const uint8_t* src, uint8_t* luma, size_t pixelCount) {
+	const __m128i r0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+	const __m128i b0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+	const __m128i wr = _mm_set1_epi16(77);
+	const __m128i wg = _mm_set1_epi16(150);
+	const __m128i wb = _mm_set1_epi16(29);
+	const __m128i round = _mm_set1_epi16(128);
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 16 <= pixelCount; i += 16) {
+		const uint8_t* px = src + i * 3;
+		__m128i a = _mm_loadu_si128((const __m128i*)px);
+		__m128i b = _mm_loadu_si128((const __m128i*)(px + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(px + 32));
+		__m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, r0), _mm_shuffle_epi8(b, r1)), _mm_shuffle_epi8(c, r2));
+		__m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, g0), _mm_shuffle_epi8(b, g1)), _mm_shuffle_epi8(c, g2));
+		__m128i bl = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, b0), _mm_shuffle_epi8(b, b1)), _mm_shuffle_epi8(c, b2));
+
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(r, zero), wr), round);
+		lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), wg));
+		lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(bl, zero), wb));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(r, zero), wr), round);
+		hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), wg));
+		hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(bl, zero), wb));
+		_mm_storeu_si128((__m128i*)(luma + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+	}
+	return i;
+}
+#endif
+
+void convertToLuma(const uint8_t* src, size_t channels, uint8_t* luma, size_t pixelCount) {
+	if (channels == 1) {
+		memcpy(luma, src, pixelCount);
+		return;
+	}
+
+	size_t i = 0;
+
+	if (channels == 3) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+		// 16 pixels per step: de-interleave, widen-multiply-accumulate, round and narrow
+		const uint8x8_t wr = vdup_n_u8(77);
+		const uint8x8_t wg = vdup_n_u8(150);
+		const uint8x8_t wb = vdup_n_u8(29);
+		for (; i + 16 <= pixelCount; i += 16) {
+			uint8x16x3_t px = vld3q_u8(src + i * 3);
+			uint16x8_t lo = vmull_u8(vget_low_u8(px.val[0]), wr);
+			lo = vmlal_u8(lo, vget_low_u8(px.val[1]), wg);
+			lo = vmlal_u8(lo, vget_low_u8(px.val[2]), wb);
+			uint16x8_t hi = vmull_u8(vget_high_u8(px.val[0]), wr);
+			hi = vmlal_u8(hi, vget_high_u8(px.val[1]), wg);
+			hi = vmlal_u8(hi, vget_high_u8(px.val[2]), wb);
+			vst1q_u8(luma + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+		}
+#elif defined(LUMA_SSSE3)
+		static const bool ssse3 = hasSsse3();
+		if (ssse3) {
+			i = convertRgbSsse3(src, luma, pixelCount);
+		}
+#endif
+		for (; i < pixelCount; i++) {
+			luma[i] = lumaOf(src + i * 3);
+		}
+		return;
+	}
+
+	for (; i < pixelCount; i++) {
+		luma[i] = lumaOf(src + i * channels);
+	}
+}
+
+void convertToLumaScalar(const uint8_t* src, size_t channels, uint8_t* luma, size_t pixelCount) {
+	for (size_t i = 0; i < pixelCount; i++) {
+		luma[i] = lumaOf(src + i * channels);
+	}
+}
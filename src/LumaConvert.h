@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Packed RGB(A) -> 8-bit luma using BT.601 weights in 8-bit fixed point
+// (77/150/29 out of 256). RGB goes through NEON on Apple Silicon / ARM and
+// SSSE3 on x86 (picked at runtime, scalar on CPUs without it).
+void convertToLuma(const uint8_t* src, size_t channels, uint8_t* luma, size_t pixelCount);
+
+// Plain per-pixel loop (3 or 4 channels), the reference the SIMD kernels must match
+void convertToLumaScalar(const uint8_t* src, size_t channels, uint8_t* luma, size_t pixelCount);
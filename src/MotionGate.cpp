@@ -0,0 +1,72 @@
+#include "MotionGate.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Sum of absolute differences over two byte arrays. Kept as a plain loop
+// over restrict pointers so the compiler vectorizes it (psadbw / vabd).
+static uint32_t sumAbsDiff(const unsigned char* __restrict a, const unsigned char* __restrict b, size_t count) {
+	uint32_t sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		sum += (uint32_t)std::abs((int)a[i] - (int)b[i]);
+	}
+	return sum;
+}
+
+void MotionGate::setup(int w, int h, int f) {
+	width = w;
+	height = h;
+	factor = std::min(std::max(1, f), 16); // 16x16 box of 255s still fits in uint16_t
+	smallWidth = width / factor;
+	smallHeight = height / factor;
+
+	// Reused every frame - no per-frame allocation
+	rowSums.assign(smallWidth, 0);
+	current.assign(smallWidth * smallHeight, 0);
+	previous.assign(smallWidth * smallHeight, 0);
+	hasPrevious = false;
+}
+
+bool MotionGate::hasMotion(const unsigned char* gray, int stride) {
+	if (current.empty()) {
+		return true;
+	}
+
+	downsample(gray, stride, current.data());
+
+	bool motion = true;
+	if (hasPrevious) {
+		uint32_t sum = sumAbsDiff(current.data(), previous.data(), current.size());
+		lastDifference = (float)sum / current.size();
+		motion = lastDifference >= threshold;
+	}
+
+	current.swap(previous);
+	hasPrevious = true;
+	return motion;
+}
+
+void MotionGate::downsample(const unsigned char* gray, int stride, unsigned char* dst) {
+	const int area = factor * factor;
+
+	for (int sy = 0; sy < smallHeight; sy++) {
+		std::fill(rowSums.begin(), rowSums.end(), 0);
+
+		// Accumulate factor rows, then collapse each factor-wide run
+		for (int r = 0; r < factor; r++) {
+			const unsigned char* row = gray + (size_t)(sy * factor + r) * stride;
+			for (int sx = 0; sx < smallWidth; sx++) {
+				const unsigned char* px = row + sx * factor;
+				uint16_t sum = 0;
+				for (int k = 0; k < factor; k++) {
+					sum += px[k];
+				}
+				rowSums[sx] += sum;
+			}
+		}
+
+		unsigned char* out = dst + (size_t)sy * smallWidth;
+		for (int sx = 0; sx < smallWidth; sx++) {
+			out[sx] = (unsigned char)(rowSums[sx] / area);
+		}
+	}
+}
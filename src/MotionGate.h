@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Cheap presence check in front of the Haar cascade.
+// Each grayscale frame is box-downsampled and compared with the previous
+// one using a sum of absolute differences; a static room scores near zero.
+class MotionGate {
+public:
+    void setup(int width, int height, int factor);
+    void setThreshold(float meanDifference) { threshold = meanDifference; }
+
+    // Returns true if the frame differs enough from the last one
+    bool hasMotion(const unsigned char* gray, int stride);
+
+    float getLastDifference() const { return lastDifference; }  // Mean abs diff per pixel (0-255)
+
+private:
+    void downsample(const unsigned char* gray, int stride, unsigned char* dst);
+
+    int width = 0;
+    int height = 0;
+    int factor = 4;
+    int smallWidth = 0;
+    int smallHeight = 0;
+    float threshold = 2.0f;
+    float lastDifference = 0.0f;
+
+    std::vector<uint16_t> rowSums;
+    std::vector<unsigned char> current;
+    std::vector<unsigned char> previous;
+    bool hasPrevious = false;
+};
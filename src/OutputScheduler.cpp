@@ -0,0 +1,107 @@
+#include "OutputScheduler.h"
+#include "PerfTimers.h"
+
+// Seconds between per-output frame-time reports
+#define SCHEDULER_REPORT_INTERVAL 10
+
+void OutputScheduler::setup(const vector<shared_ptr<ofAppBaseWindow>>& windows, float targetFps) {
+	periodMicros = (uint64_t)(1000000.0 / std::max(1.0f, targetFps));
+	outputs.clear();
+
+	// Every output starts on the same deadline; window 0 goes first since it updates the manager
+	uint64_t now = ofGetElapsedTimeMicros();
+	for (auto & window : windows) {
+		Output output;
+		output.window = window;
+		output.deadline = now;
+		outputs.push_back(std::move(output));
+	}
+	lastReportMicros = now;
+	ofLogNotice() << "Output scheduler: " << outputs.size() << " outputs at " << targetFps << "fps";
+}
+
+int OutputScheduler::run() {
+	auto mainLoop = ofGetMainLoop();
+
+	while (!outputs.empty()) {
+		mainLoop->pollEvents();
+
+		// Drop closed windows
+		for (size_t i = 0; i < outputs.size(); ) {
+			if (outputs[i].window->getWindowShouldClose()) {
+				outputs[i].window->close();
+				outputs.erase(outputs.begin() + i);
+			} else {
+				i++;
+			}
+		}
+		if (outputs.empty()) {
+			break;
+		}
+
+		// Earliest deadline first (ties go to the lower index, so window 0 leads)
+		Output* next = &outputs[0];
+		for (auto & output : outputs) {
+			if (output.deadline < next->deadline) {
+				next = &output;
+			}
+		}
+
+		uint64_t now = ofGetElapsedTimeMicros();
+		if (next->deadline > now + 1000) {
+			ofSleepMillis((next->deadline - now) / 1000);
+			continue; // Poll events again before presenting
+		}
+
+		present(*next);
+	}
+
+	mainLoop->exit();
+	return 0;
+}
+
+void OutputScheduler::present(Output& output) {
+	auto mainLoop = ofGetMainLoop();
+	mainLoop->setCurrentWindow(output.window);
+	output.window->makeCurrent();
+	output.window->update();
+	{
+		PERF_SCOPE(PERF_PRESENT);
+		output.window->draw(); // Swaps buffers
+	}
+
+	uint64_t now = ofGetElapsedTimeMicros();
+	if (output.lastPresent > 0) {
+		output.intervals.add((now - output.lastPresent) / 1000.0);
+	}
+	output.lastPresent = now;
+
+	// Next period; if we're already past it, skip ahead instead of bursting to catch up
+	output.deadline += periodMicros;
+	if (output.deadline <= now) {
+		uint64_t behind = (now - output.deadline) / periodMicros + 1;
+		output.missedDeadlines += behind;
+		output.deadline += behind * periodMicros;
+	}
+
+	if (now - lastReportMicros > SCHEDULER_REPORT_INTERVAL * 1000000ULL) {
+		report();
+		lastReportMicros = now;
+	}
+}
+
+void OutputScheduler::report() {
+	double periodMillis = periodMicros / 1000.0;
+	for (size_t i = 0; i < outputs.size(); i++) {
+		FrameHistogram& intervals = outputs[i].intervals;
+		if (intervals.count == 0) {
+			continue;
+		}
+		ofLogNotice() << "Output " << i << " frame time: p50 " << intervals.percentile(0.50)
+			<< "ms, p95 " << intervals.percentile(0.95) << "ms, p99 " << intervals.percentile(0.99)
+			<< "ms, max " << intervals.maximum << "ms - " << intervals.countAbove(periodMillis * 1.5)
+			<< " of " << intervals.count << " frames stuttered, " << outputs[i].missedDeadlines << " deadlines missed";
+		intervals.reset();
+		outputs[i].missedDeadlines = 0;
+	}
+}
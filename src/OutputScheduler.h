@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FrameHistogram.h"
+
+// Replaces ofRunMainLoop() with a deadline-driven present order. Every output
+// gets its own present deadline each refresh period and is rendered in
+// deadline order, so one window's slow frame pushes back only the windows
+// behind it in that period instead of the shared loop's fixed round-robin.
+// Missed deadlines are skipped rather than queued up. Frame-to-frame
+// intervals are recorded per output to measure stutter and tearing.
+class OutputScheduler {
+public:
+    void setup(const vector<shared_ptr<ofAppBaseWindow>>& windows, float targetFps);
+    int run(); // Until every window has closed
+
+private:
+    struct Output {
+        shared_ptr<ofAppBaseWindow> window;
+        uint64_t deadline = 0;      // Next present, micros
+        uint64_t lastPresent = 0;
+        uint64_t missedDeadlines = 0;
+        FrameHistogram intervals;   // Present-to-present, ms
+    };
+
+    void present(Output& output);
+    void report();
+
+    vector<Output> outputs;
+    uint64_t periodMicros = 16667;
+    uint64_t lastReportMicros = 0;
+};
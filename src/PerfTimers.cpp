@@ -0,0 +1,288 @@
+#include "PerfTimers.h"
+#include <fstream>
+#include <set>
+
+// Samples each thread can buffer between collect() calls
+#define PERF_RING_SIZE 4096
+
+std::atomic<bool> PerfTimers::enabled{false};
+
+namespace {
+
+// Trace track ids: windows are 1..N, other threads follow from here
+#define PERF_THREAD_TRACK_BASE 100
+
+struct PerfSample {
+	uint8_t stage;
+	int16_t window;     // Window the render thread was working for, -1 elsewhere
+	uint32_t micros;
+	uint64_t start;
+};
+
+// Single-producer / single-consumer ring owned by one recording thread.
+// Rings are reused once their thread exits, so short-lived threads
+// (one decoder per clip) don't grow the registry.
+struct PerfRing {
+	std::array<PerfSample, PERF_RING_SIZE> samples;
+	std::atomic<uint64_t> head{0};  // Consumer (render thread)
+	std::atomic<uint64_t> tail{0};  // Producer
+	std::atomic<uint64_t> dropped{0};
+	std::atomic<bool> inUse{false};
+	int index = 0;
+	string name;        // Set by its thread before the first sample
+};
+
+struct StageStats {
+	uint64_t count = 0;
+	uint64_t totalMicros = 0;
+	uint32_t maxMicros = 0;
+};
+
+std::mutex registryMutex;
+vector<unique_ptr<PerfRing>> rings;
+
+// Releases the thread's ring when the thread exits
+struct ThreadRing {
+	PerfRing* ring = nullptr;
+	int window = -1;
+	~ThreadRing() {
+		if (ring) ring->inUse = false;
+	}
+};
+thread_local ThreadRing threadRing;
+
+PerfRing* acquireRing() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (auto & ring : rings) {
+		bool expected = false;
+		if (ring->inUse.compare_exchange_strong(expected, true)) {
+			return ring.get();
+		}
+	}
+	rings.push_back(make_unique<PerfRing>());
+	rings.back()->inUse = true;
+	rings.back()->index = (int)rings.size() - 1;
+	return rings.back().get();
+}
+
+// Render-thread state
+std::array<StageStats, PERF_NUM_STAGES> current;    // Second being collected
+std::array<StageStats, PERF_NUM_STAGES> lastSecond; // Shown in the HUD
+uint64_t windowStartMicros = 0;
+uint64_t droppedTotal = 0;
+bool requested = false;   // Last setEnabled(), what's left once streaming stops
+std::ofstream csv;
+string csvPath;
+size_t csvMaxBytes = 0;
+size_t csvBytes = 0;
+
+// Trace state (render thread)
+std::ofstream trace;
+string tracePath;
+uint64_t traceEndMicros = 0;
+uint64_t traceEvents = 0;
+std::set<int> namedTracks;
+
+int trackFor(const PerfRing& ring, const PerfSample& sample) {
+	return sample.window >= 0 ? sample.window + 1 : PERF_THREAD_TRACK_BASE + ring.index;
+}
+
+void writeTraceEvent(const string& event) {
+	trace << (traceEvents++ > 0 ? ",\n" : "") << event;
+}
+
+void traceSample(const PerfRing& ring, const PerfSample& sample) {
+	int track = trackFor(ring, sample);
+	if (namedTracks.insert(track).second) {
+		// Name the track the first time it shows up
+		string name = sample.window >= 0 ? "window " + ofToString(sample.window) : (ring.name.empty() ? "thread " + ofToString(ring.index) : ring.name);
+		writeTraceEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + ofToString(track)
+			+ ",\"args\":{\"name\":\"" + name + "\"}}");
+	}
+	writeTraceEvent("{\"name\":\"" + string(PerfTimers::stageName((PerfStage)sample.stage)) + "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+		+ ofToString(track) + ",\"ts\":" + ofToString(sample.start) + ",\"dur\":" + ofToString(sample.micros) + "}");
+}
+
+void openCsv() {
+	csv.open(csvPath, std::ios::trunc);
+	string header = "time_s,stage,count,avg_ms,max_ms\n";
+	csv << header;
+	csvBytes = header.size();
+}
+
+void writeCsv(float seconds) {
+	if (!csv.is_open()) {
+		return;
+	}
+	for (int i = 0; i < PERF_NUM_STAGES; i++) {
+		const StageStats& stats = lastSecond[i];
+		if (stats.count == 0) {
+			continue;
+		}
+		string row = ofToString(seconds, 3) + "," + PerfTimers::stageName((PerfStage)i) + "," + ofToString(stats.count) + ","
+			+ ofToString(stats.totalMicros / 1000.0 / stats.count, 3) + "," + ofToString(stats.maxMicros / 1000.0, 3) + "\n";
+		csv << row;
+		csvBytes += row.size();
+	}
+	csv.flush();
+
+	// Roll over: keep the previous file as <path>.1
+	if (csvBytes > csvMaxBytes) {
+		csv.close();
+		std::rename(csvPath.c_str(), (csvPath + ".1").c_str());
+		openCsv();
+	}
+}
+
+}
+
+void PerfTimers::setEnabled(bool enable) {
+	requested = enable;
+	enabled.store(enable || isStreaming(), std::memory_order_relaxed);
+}
+
+void PerfTimers::nameThread(const string& name) {
+	if (!threadRing.ring) {
+		threadRing.ring = acquireRing();
+	}
+	std::lock_guard<std::mutex> lock(registryMutex);
+	threadRing.ring->name = name;
+}
+
+void PerfTimers::setWindowTrack(int windowIndex) {
+	threadRing.window = windowIndex;
+}
+
+void PerfTimers::record(PerfStage stage, uint64_t startMicros, uint64_t endMicros) {
+	if (!threadRing.ring) {
+		threadRing.ring = acquireRing();
+	}
+	PerfRing& ring = *threadRing.ring;
+
+	uint64_t t = ring.tail.load(std::memory_order_relaxed);
+	if (t - ring.head.load(std::memory_order_acquire) >= PERF_RING_SIZE) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	PerfSample& sample = ring.samples[t % PERF_RING_SIZE];
+	sample.stage = (uint8_t)stage;
+	sample.window = (int16_t)threadRing.window;
+	sample.start = startMicros;
+	sample.micros = (uint32_t)std::min<uint64_t>(endMicros - startMicros, UINT32_MAX);
+	ring.tail.store(t + 1, std::memory_order_release);
+}
+
+void PerfTimers::collect() {
+	{
+		// Only blocks against a thread recording its very first sample
+		std::lock_guard<std::mutex> lock(registryMutex);
+		for (auto & ring : rings) {
+			uint64_t h = ring->head.load(std::memory_order_relaxed);
+			uint64_t t = ring->tail.load(std::memory_order_acquire);
+			for (; h < t; h++) {
+				const PerfSample& sample = ring->samples[h % PERF_RING_SIZE];
+				StageStats& stats = current[sample.stage];
+				stats.count++;
+				stats.totalMicros += sample.micros;
+				stats.maxMicros = std::max(stats.maxMicros, sample.micros);
+				if (trace.is_open()) {
+					traceSample(*ring, sample);
+				}
+			}
+			ring->head.store(h, std::memory_order_release);
+			droppedTotal += ring->dropped.exchange(0, std::memory_order_relaxed);
+		}
+	}
+
+	uint64_t now = ofGetElapsedTimeMicros();
+	if (trace.is_open() && now >= traceEndMicros) {
+		stopTrace();
+	}
+
+	if (windowStartMicros == 0) {
+		windowStartMicros = now;
+	}
+	if (now - windowStartMicros >= 1000000) {
+		lastSecond = current;
+		current = {};
+		windowStartMicros = now;
+		writeCsv(now / 1000000.0f);
+	}
+}
+
+void PerfTimers::drawHud(float x, float y) {
+	string text = isEnabled() ? "PERF (last second)      calls   avg ms   max ms\n" : "PERF (timers off)\n";
+	for (int i = 0; i < PERF_NUM_STAGES; i++) {
+		const StageStats& stats = lastSecond[i];
+		char line[96];
+		snprintf(line, sizeof(line), "%-20s %8llu %8.3f %8.3f\n", stageName((PerfStage)i),
+			(unsigned long long)stats.count, stats.count > 0 ? stats.totalMicros / 1000.0 / stats.count : 0.0,
+			stats.maxMicros / 1000.0);
+		text += line;
+	}
+	if (droppedTotal > 0) {
+		text += ofToString(droppedTotal) + " samples dropped (ring full)\n";
+	}
+	ofDrawBitmapStringHighlight(text, x, y);
+}
+
+void PerfTimers::startCsv(const string& path, size_t maxBytes) {
+	csvPath = path;
+	csvMaxBytes = maxBytes;
+	openCsv();
+	ofLogNotice() << "Perf timings streaming to " << path;
+}
+
+bool PerfTimers::isStreaming() {
+	return csv.is_open() || trace.is_open();
+}
+
+void PerfTimers::startTrace(const string& path, float maxSeconds) {
+	tracePath = path;
+	trace.open(path, std::ios::trunc);
+	if (!trace) {
+		ofLogError() << "Could not write trace " << path;
+		return;
+	}
+	// Unterminated arrays are valid trace files, so a crash still leaves a usable trace
+	trace << "[\n";
+	traceEvents = 0;
+	namedTracks.clear();
+	traceEndMicros = ofGetElapsedTimeMicros() + (uint64_t)(maxSeconds * 1000000.0f);
+	enabled.store(true, std::memory_order_relaxed);
+	ofLogNotice() << "Tracing to " << path << " for " << maxSeconds << "s";
+}
+
+void PerfTimers::stopTrace() {
+	if (!trace.is_open()) {
+		return;
+	}
+	trace << "\n]\n";
+	trace.close();
+	// Back to what the HUD (or CSV) still needs
+	enabled.store(requested || isStreaming(), std::memory_order_relaxed);
+	ofLogNotice() << "Trace written: " << tracePath << " (" << traceEvents << " events)";
+}
+
+bool PerfTimers::isTracing() {
+	return trace.is_open();
+}
+
+const char* PerfTimers::stageName(PerfStage stage) {
+	switch (stage) {
+		case PERF_CAPTURE: return "capture";
+		case PERF_GRAYSCALE: return "grayscale";
+		case PERF_DETECT: return "haar_detect";
+		case PERF_TRACK: return "track";
+		case PERF_PROXIMITY: return "proximity";
+		case PERF_DECODE: return "video_decode";
+		case PERF_UPLOAD: return "texture_upload";
+		case PERF_FBO_RENDER: return "fbo_render";
+		case PERF_SHADER: return "shader_pass";
+		case PERF_PRESENT: return "present";
+		case PERF_APP_UPDATE: return "app_update";
+		case PERF_APP_DRAW: return "app_draw";
+		case PERF_GL_DRAW: return "gl_draw";
+		default: return "unknown";
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ofMain.h"
+#include <array>
+#include <atomic>
+
+// Compile the scoped timers out entirely with 0
+#define PERF_TIMERS 1
+
+// Hot-path stages timed by PERF_SCOPE
+enum PerfStage {
+    PERF_CAPTURE,       // Webcam source update (render thread)
+    PERF_GRAYSCALE,     // RGB -> luma on submit (render thread)
+    PERF_DETECT,        // Haar cascade (detection thread)
+    PERF_TRACK,         // Median-flow tracking (detection thread)
+    PERF_PROXIMITY,     // updateProximity (detection thread)
+    PERF_DECODE,        // Player update + queue copy (decoder thread)
+    PERF_UPLOAD,        // Webcam / video texture upload (render thread)
+    PERF_FBO_RENDER,    // Scene into the render FBO
+    PERF_SHADER,        // Glitch pass
+    PERF_PRESENT,       // A window's draw + buffer swap
+    PERF_APP_UPDATE,    // DisplayApp::update
+    PERF_APP_DRAW,      // DisplayApp::draw
+    PERF_GL_DRAW,       // Final textured draw to a window
+    PERF_NUM_STAGES
+};
+
+// Per-stage timing collected from every thread. Each thread records into its
+// own lock-free ring (single producer); the render thread drains all rings in
+// collect(), keeps per-second stats for the HUD, streams them to a rolling
+// CSV and, while tracing, writes every span as a Chrome trace event.
+// While disabled a timer costs one relaxed atomic load.
+class PerfTimers {
+public:
+    static void setEnabled(bool enabled);  // Timers also run while a CSV or trace is being written
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Any thread
+    static void record(PerfStage stage, uint64_t startMicros, uint64_t endMicros);
+    static void nameThread(const string& name);   // Track name in traces
+    // Render thread: spans recorded from here on go on this window's track
+    static void setWindowTrack(int windowIndex);
+
+    // Render thread: drain the rings, roll the per-second stats, write the CSV
+    static void collect();
+    static void drawHud(float x, float y);
+
+    // Rolling CSV (one row per stage per second), rotated to <path>.1 past maxBytes
+    static void startCsv(const string& path, size_t maxBytes);
+    static bool isStreaming();
+
+    // Trace-event JSON (chrome://tracing, ui.perfetto.dev), stops itself after maxSeconds
+    static void startTrace(const string& path, float maxSeconds);
+    static void stopTrace();
+    static bool isTracing();
+
+    static const char* stageName(PerfStage stage);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#if PERF_TIMERS
+// Times the enclosing scope
+class ScopedPerfTimer {
+public:
+    explicit ScopedPerfTimer(PerfStage stage) : stage(stage), active(PerfTimers::isEnabled()) {
+        if (active) start = ofGetElapsedTimeMicros();
+    }
+    ~ScopedPerfTimer() {
+        if (active) PerfTimers::record(stage, start, ofGetElapsedTimeMicros());
+    }
+
+private:
+    PerfStage stage;
+    bool active;
+    uint64_t start = 0;
+};
+
+#define PERF_SCOPE_NAME(line) perfScope##line
+#define PERF_SCOPE_LINE(stage, line) ScopedPerfTimer PERF_SCOPE_NAME(line)(stage)
+#define PERF_SCOPE(stage) PERF_SCOPE_LINE(stage, __LINE__)
+#else
+#define PERF_SCOPE(stage)
+#endif
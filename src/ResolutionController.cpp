@@ -0,0 +1,70 @@
+#include "ResolutionController.h"
+
+// Step up only well under budget, since one step roughly doubles a target's pixels
+#define RESOLUTION_HEADROOM 0.6f
+// Frames to wait after a change (GPU results arrive a few frames late)
+#define RESOLUTION_COOLDOWN_FRAMES 45
+// Frame-time smoothing (exponential moving average weight)
+#define RESOLUTION_SMOOTHING 0.1f
+
+const RenderSize ResolutionController::sizes[NUM_SIZES] = {
+	{ 320, 240 }, { 480, 360 }, { 640, 480 }, { 960, 720 }, { 1280, 960 }, { 1920, 1440 }
+};
+
+int ResolutionController::levelFor(float width, float height) {
+	for (int i = 0; i < NUM_SIZES; i++) {
+		if (sizes[i].width >= width && sizes[i].height >= height) {
+			return i;
+		}
+	}
+	return NUM_SIZES - 1;
+}
+
+void ResolutionController::setup(int numTargets, int startLevel, float budget) {
+	startLevel = ofClamp(startLevel, 0, NUM_SIZES - 1);
+	levels.assign(numTargets, startLevel);
+	maxLevels.assign(numTargets, startLevel);
+	budgetMillis = budget;
+	smoothedMillis = 0.0f;
+	cooldown = 0;
+}
+
+void ResolutionController::setMaxLevel(int target, int level) {
+	maxLevels[target] = ofClamp(level, 0, NUM_SIZES - 1);
+	levels[target] = std::min(levels[target], maxLevels[target]);
+}
+
+int ResolutionController::update(float frameMillis) {
+	if (!enabled || levels.empty()) {
+		return -1;
+	}
+	smoothedMillis = smoothedMillis > 0.0f ? ofLerp(smoothedMillis, frameMillis, RESOLUTION_SMOOTHING) : frameMillis;
+	if (cooldown > 0) {
+		cooldown--;
+		return -1;
+	}
+
+	int changed = -1;
+	if (smoothedMillis > budgetMillis) {
+		// Over budget: the largest target gives up a size
+		for (int i = 0; i < (int)levels.size(); i++) {
+			if (levels[i] > 0 && (changed < 0 || levels[i] > levels[changed])) {
+				changed = i;
+			}
+		}
+		if (changed >= 0) levels[changed]--;
+	} else if (smoothedMillis < budgetMillis * RESOLUTION_HEADROOM) {
+		// Headroom: the smallest target below its cap gains a size
+		for (int i = 0; i < (int)levels.size(); i++) {
+			if (levels[i] < maxLevels[i] && (changed < 0 || levels[i] < levels[changed])) {
+				changed = i;
+			}
+		}
+		if (changed >= 0) levels[changed]++;
+	}
+
+	if (changed >= 0) {
+		cooldown = RESOLUTION_COOLDOWN_FRAMES;
+	}
+	return changed;
+}
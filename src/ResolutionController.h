@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ofMain.h"
+
+struct RenderSize {
+    int width;
+    int height;
+};
+
+// Picks each render target's FBO size from a fixed pool against a GPU time
+// budget per frame. Over budget it steps the largest target down one size;
+// with clear headroom it steps the smallest one up, no further than the cap
+// its content allows. One change at a time, then a cooldown so the next
+// decision sees the effect of the last.
+class ResolutionController {
+public:
+    static const int NUM_SIZES = 6;
+    static const RenderSize sizes[NUM_SIZES];   // Ascending, 4:3 like the webcam
+
+    // Smallest pool size covering width x height (the largest if none does)
+    static int levelFor(float width, float height);
+
+    void setup(int numTargets, int startLevel, float budgetMillis);
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+
+    // Highest size a target may use; lowering it takes effect at once
+    void setMaxLevel(int target, int level);
+
+    // Once per frame with the measured GPU time, returns the target it changed or -1
+    int update(float frameMillis);
+
+    int getLevel(int target) const { return levels[target]; }
+    const RenderSize& getSize(int target) const { return sizes[levels[target]]; }
+    float getSmoothedMillis() const { return smoothedMillis; }
+    float getBudgetMillis() const { return budgetMillis; }
+
+private:
+    vector<int> levels;
+    vector<int> maxLevels;
+    float budgetMillis = 10.0f;
+    float smoothedMillis = 0.0f;
+    int cooldown = 0;
+    bool enabled = true;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer handoff.
+// The writer fills back() and publish()es it; the reader calls update() to
+// pick up the newest published slot. Unread values are overwritten, so the
+// reader always sees the latest one and neither side ever waits on the other.
+template<typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        uint8_t previous = shared.exchange(backIndex | FRESH_BIT, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side - returns true if a newer value was picked up
+    bool update() {
+        if (!(shared.load(std::memory_order_acquire) & FRESH_BIT)) {
+            return false;
+        }
+        uint8_t previous = shared.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    bool hasFresh() const { return shared.load(std::memory_order_acquire) & FRESH_BIT; }
+
+    T& front() { return slots[frontIndex]; }
+    const T& front() const { return slots[frontIndex]; }
+
+    // Only safe before the producer/consumer threads start (e.g. preallocation)
+    std::array<T, 3>& allSlots() { return slots; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> slots;
+    uint8_t backIndex = 0;              // Writer-owned
+    std::atomic<uint8_t> shared{1};     // Slot in flight between the two
+    uint8_t frontIndex = 2;             // Reader-owned
+};
@@ -0,0 +1,153 @@
+#include "VideoDecoder.h"
+#include "PerfTimers.h"
+
+// Frames are presented this long after their decode time to absorb jitter
+static const double PRESENTATION_LATENCY = 0.05;
+
+VideoDecoder::~VideoDecoder() {
+	stop();
+}
+
+void VideoDecoder::start(const string& clipPath, bool prerollOnly) {
+	path = clipPath;
+	playRequested = !prerollOnly;
+	startThread();
+}
+
+void VideoDecoder::play() {
+	playRequested = true;
+}
+
+void VideoDecoder::stop() {
+	if (isThreadRunning()) {
+		waitForThread(true);
+	}
+}
+
+float VideoDecoder::getDecodeMillis() const {
+	uint64_t count = decodedFrames.load();
+	return count > 0 ? totalDecodeMicros.load() / 1000.0f / count : 0.0f;
+}
+
+void VideoDecoder::threadedFunction() {
+	PerfTimers::nameThread("video decode");
+	player.setUseTexture(false);  // Disable GL texture - no context on this thread
+	player.setPixelFormat(OF_PIXELS_RGB);
+	if (!player.load(path)) {
+		ofLogError() << "Failed to load video: " << path;
+		failed = true;
+		exited = true;
+		return;
+	}
+
+	int w = player.getWidth();
+	int h = player.getHeight();
+	// Preallocate the pool so decoding never allocates per frame
+	for (auto & frame : pool) {
+		frame.pixels.allocate(w, h, OF_PIXELS_RGB);
+	}
+	width = w;
+	height = h;
+
+	player.setLoopState(OF_LOOP_NONE);
+	player.play();
+	loaded = true;
+	ofLogNotice() << (playRequested ? "Decoding video: " : "Pre-rolling video: ")
+		<< ofFilePath::getFileName(path) << " (" << w << "x" << h << ")";
+
+	bool waitingToPlay = false;
+	while (isThreadRunning()) {
+		// Pre-rolled: hold the first frame until the clip is switched in
+		if (waitingToPlay) {
+			if (!playRequested) {
+				sleep(2);
+				continue;
+			}
+			player.setPaused(false);
+			waitingToPlay = false;
+		}
+
+		uint64_t start = ofGetElapsedTimeMicros();
+		player.update();
+
+		if (player.isFrameNew()) {
+			double pts = player.getPosition() * player.getDuration();
+			pushFrame(player.getPixels(), pts);
+			uint64_t end = ofGetElapsedTimeMicros();
+			totalDecodeMicros += end - start;
+			decodedFrames++;
+			if (PerfTimers::isEnabled()) {
+				PerfTimers::record(PERF_DECODE, start, end);
+			}
+
+			if (!playRequested) {
+				player.setPaused(true);
+				waitingToPlay = true;
+				continue;
+			}
+		}
+
+		// Check if video reached the end (current frame >= total frames or video stopped)
+		if (player.getTotalNumFrames() > 0 &&
+		    (player.getCurrentFrame() >= player.getTotalNumFrames() - 1 || !player.isPlaying())) {
+			finished = true;
+			clipEnded.notifyDeferred(this);
+			break;
+		}
+
+		sleep(2); // Poll well above the clip's frame rate
+	}
+
+	player.close();
+	exited = true;
+}
+
+bool VideoDecoder::pushFrame(const ofPixels& pixels, double pts) {
+	uint64_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) >= QUEUE_SIZE) {
+		droppedFull++;
+		return false;
+	}
+
+	VideoFrame& frame = pool[t % QUEUE_SIZE];
+	if (frame.pixels.getTotalBytes() == pixels.getTotalBytes()) {
+		memcpy(frame.pixels.getData(), pixels.getData(), pixels.getTotalBytes());
+	} else {
+		frame.pixels = pixels; // Size changed mid-clip - only case that allocates
+	}
+	frame.pts = pts;
+	frame.number = t;
+
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+const VideoFrame* VideoDecoder::nextDueFrame(float now) {
+	uint64_t h = head.load(std::memory_order_relaxed);
+	uint64_t t = tail.load(std::memory_order_acquire);
+	if (h == t) {
+		return nullptr;
+	}
+
+	// Start the clip's clock on its first frame, which is shown right away
+	bool firstFrame = !clockStarted;
+	if (firstFrame) {
+		clockOrigin = now - pool[h % QUEUE_SIZE].pts + PRESENTATION_LATENCY;
+		clockStarted = true;
+	}
+	double clipTime = now - clockOrigin;
+
+	// Drop due frames that a newer due frame supersedes
+	while (t - h > 1 && pool[(h + 1) % QUEUE_SIZE].pts <= clipTime) {
+		h++;
+		droppedLate++;
+	}
+	head.store(h, std::memory_order_release);
+
+	const VideoFrame& frame = pool[h % QUEUE_SIZE];
+	return (firstFrame || frame.pts <= clipTime) ? &frame : nullptr;
+}
+
+void VideoDecoder::popFrame() {
+	head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
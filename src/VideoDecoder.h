@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ofMain.h"
+
+// One decoded video frame in the decoder's pool
+struct VideoFrame {
+    ofPixels pixels;
+    double pts = 0.0;       // Presentation time within the clip, seconds
+    uint64_t number = 0;    // Sequence number within the clip
+};
+
+// Plays one clip on its own thread and fills a bounded, preallocated frame
+// queue (single producer / single consumer ring). The render thread takes
+// frames by presentation clock, so decode stalls are absorbed by the queue
+// instead of showing up as dropped frames on every output.
+class VideoDecoder : public ofThread {
+public:
+    static const int QUEUE_SIZE = 4;
+
+    ~VideoDecoder();
+
+    // With prerollOnly the clip is opened and its first frame queued, then
+    // it waits paused until play() - used to have the next clip ready ahead of time
+    void start(const string& path, bool prerollOnly = false);
+    void play();
+    void stop();
+
+    // Render thread: newest frame due at `now` (older due frames are dropped),
+    // or nullptr. The frame stays valid until popFrame().
+    const VideoFrame* nextDueFrame(float now);
+    void popFrame();
+
+    bool isLoaded() const { return loaded.load(); }
+    bool isReady() const { return loaded.load() && queueDepth() > 0; } // First frame is queued
+    bool isFinished() const { return finished.load() && queueDepth() == 0; }
+    bool hasFailed() const { return failed.load(); }
+    bool hasExited() const { return exited.load(); }  // Thread done, clip closed: joining won't block
+    int getWidth() const { return width.load(); }
+    int getHeight() const { return height.load(); }
+    const string& getPath() const { return path; }
+
+    // Stats
+    int queueDepth() const { return (int)(tail.load() - head.load()); }
+    uint64_t getDecodedFrames() const { return decodedFrames.load(); }
+    uint64_t getDroppedFrames() const { return droppedFull.load() + droppedLate.load(); }
+    float getDecodeMillis() const;
+    uint64_t getDecodeMicros() const { return totalDecodeMicros.load(); }
+
+    // Raised on the decoder thread with notifyDeferred once the clip is fully decoded
+    // (frames may still be queued); delivered when the owner drains it
+    ofEvent<void> clipEnded;
+
+protected:
+    void threadedFunction() override;
+
+private:
+    bool pushFrame(const ofPixels& pixels, double pts);
+
+    string path;
+    ofVideoPlayer player; // Only touched by the decoder thread
+
+    VideoFrame pool[QUEUE_SIZE];
+    std::atomic<uint64_t> head{0}; // Next frame to present (render thread)
+    std::atomic<uint64_t> tail{0}; // Next slot to fill (decoder thread)
+
+    std::atomic<bool> playRequested{true};
+    std::atomic<bool> loaded{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> failed{false};
+    std::atomic<bool> exited{false};
+    std::atomic<int> width{0};
+    std::atomic<int> height{0};
+
+    // Presentation clock (render thread)
+    bool clockStarted = false;
+    double clockOrigin = 0.0;
+
+    std::atomic<uint64_t> decodedFrames{0};
+    std::atomic<uint64_t> droppedFull{0};  // Queue full, decoder had to discard
+    std::atomic<uint64_t> droppedLate{0};  // Superseded before it was presented
+    std::atomic<uint64_t> totalDecodeMicros{0};
+};
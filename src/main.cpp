@@ -1,6 +1,9 @@
 #include "ofMain.h"
 #include "DisplayApp.h"
 #include "DisplayManager.h"
+#include "OutputScheduler.h"
+#include "BenchmarkRunner.h"
+#include "PerfTimers.h"
 #include "GLFW/glfw3.h"
 
 // Force dedicated GPU on Windows (NVIDIA Optimus / AMD PowerXpress)
@@ -16,83 +19,176 @@ shared_ptr<DisplayManager> globalManager;
 // Set to false to force windowed mode even with 3+ monitors
 const bool FORCE_WINDOWED = false;
 
-int main() {
+// Number of windows opened in windowed mode (fullscreen opens one per monitor)
+const int WINDOWED_OUTPUTS = 3;
+
+// Present windows in deadline order (false = openFrameworks' round-robin main loop)
+const bool USE_OUTPUT_SCHEDULER = true;
+const float OUTPUT_TARGET_FPS = 60.0f;
+
+// Benchmark defaults (see README: Benchmarking)
+const int BENCHMARK_WARMUP_FRAMES = 120;
+const int BENCHMARK_FRAMES = 1200;
+const string BENCHMARK_WEBCAM_CLIP = "benchmark/webcam.mov";
+
+// --perf-csv: rolling per-stage timing file, rotated past this size
+const size_t PERF_CSV_MAX_BYTES = 10 * 1024 * 1024;
+// --trace: trace-event JSON, stopped after this long unless given
+const float TRACE_DEFAULT_SECONDS = 120.0f;
+
+// Dynamic render resolution: GPU time for all outputs, as a share of one output frame
+const float DYNAMIC_RES_GPU_SHARE = 0.6f;
+
+int main(int argc, char* argv[]) {
     globalManager = make_shared<DisplayManager>();
     
+    // --benchmark [--frames N] [--outputs N] [--perf-csv path] [--trace path [--trace-seconds N]]
+    // --webcam-clip path [--webcam-fps N] [--webcam-realtime | --webcam-fixed-rate] [--webcam-no-loop]
+    // --fixed-res
+    bool benchmark = false;
+    int benchmarkFrames = BENCHMARK_FRAMES;
+    int windowedOutputs = WINDOWED_OUTPUTS;
+    string webcamClip;
+    float webcamFps = 0;
+    int webcamRealTime = -1; // Default: fixed rate when benchmarking, real time otherwise
+    bool webcamLoop = true;
+    string perfCsv;
+    string tracePath;
+    float traceSeconds = TRACE_DEFAULT_SECONDS;
+    bool fixedResolution = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--benchmark") {
+            benchmark = true;
+        } else if (arg == "--frames" && hasValue) {
+            benchmarkFrames = std::max(1, ofToInt(argv[++i]));
+        } else if (arg == "--outputs" && hasValue) {
+            windowedOutputs = std::max(1, ofToInt(argv[++i]));
+        } else if (arg == "--webcam-clip" && hasValue) {
+            webcamClip = argv[++i];
+        } else if (arg == "--webcam-fps" && hasValue) {
+            webcamFps = ofToFloat(argv[++i]);
+        } else if (arg == "--webcam-realtime") {
+            webcamRealTime = 1;
+        } else if (arg == "--webcam-fixed-rate") {
+            webcamRealTime = 0;
+        } else if (arg == "--webcam-no-loop") {
+            webcamLoop = false;
+        } else if (arg == "--perf-csv" && hasValue) {
+            perfCsv = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (arg == "--trace-seconds" && hasValue) {
+            traceSeconds = ofToFloat(argv[++i]);
+        } else if (arg == "--fixed-res") {
+            fixedResolution = true;
+        } else {
+            ofLogWarning() << "Ignoring unknown argument: " << arg;
+        }
+    }
+    if (benchmark && webcamClip.empty()) {
+        webcamClip = BENCHMARK_WEBCAM_CLIP;
+    }
+    if (!perfCsv.empty()) {
+        PerfTimers::startCsv(ofToDataPath(perfCsv, true), PERF_CSV_MAX_BYTES);
+        PerfTimers::setEnabled(true);
+    }
+    if (!tracePath.empty()) {
+        PerfTimers::startTrace(ofToDataPath(tracePath, true), traceSeconds);
+    }
+    // Benchmarks keep the fixed render size so runs stay comparable
+    globalManager->setDynamicResolution(!fixedResolution && !benchmark, 1000.0f / OUTPUT_TARGET_FPS * DYNAMIC_RES_GPU_SHARE);
+    // ...and play the same source mix: swaps and mirroring count frames at the target rate
+    if (benchmark) {
+        globalManager->setFixedShowStep(1.0f / OUTPUT_TARGET_FPS);
+    }
+    if (!webcamClip.empty()) {
+        bool realTime = webcamRealTime < 0 ? !benchmark : webcamRealTime == 1;
+        globalManager->setWebcamSource(FrameSource::createReplay(webcamClip, webcamFps, realTime, webcamLoop));
+    }
+    
     ofGLFWWindowSettings settings;
     settings.setSize(720, 480);
     settings.resizable = true;
     settings.numSamples = 0;
     settings.doubleBuffering = true;
+    settings.visible = !benchmark; // Benchmark renders offscreen
     
     // Create first window (initializes GLFW)
     settings.setPosition(ofVec2f(50, 50));
     auto window1 = ofCreateWindow(settings);
     
+    // Remaining windows share window 1's GL objects so each frame's
+    // textures are uploaded once and sampled by every context
+    settings.shareContextWith = window1;
+    
     // Now query monitors
     int monitorCount = 0;
     GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
     ofLogNotice() << "Detected " << monitorCount << " monitor(s)";
     
-    shared_ptr<ofAppBaseWindow> window2, window3;
+    vector<shared_ptr<ofAppBaseWindow>> windows = { window1 };
     
-    // Auto fullscreen when 3+ monitors detected (unless forced windowed)
-    if (!FORCE_WINDOWED && monitorCount >= 3) {
-        // Resize window1 to fullscreen on monitor 0
+    // Auto fullscreen with one output per monitor when 3+ monitors detected (unless forced windowed)
+    if (!FORCE_WINDOWED && !benchmark && monitorCount >= 3) {
+        // Window 1 goes on monitor 0 - resized below, once the other windows exist
         const GLFWvidmode* mode0 = glfwGetVideoMode(monitors[0]);
         int mx0, my0;
         glfwGetMonitorPos(monitors[0], &mx0, &my0);
         ofLogNotice() << "Monitor 0: " << mode0->width << "x" << mode0->height;
         
-        // Create window 2 on monitor 1
-        const GLFWvidmode* mode1 = glfwGetVideoMode(monitors[1]);
-        int mx1, my1;
-        glfwGetMonitorPos(monitors[1], &mx1, &my1);
+        // Create a borderless window on each remaining monitor
         settings.decorated = false;
-        settings.setSize(mode1->width, mode1->height);
-        settings.setPosition(ofVec2f(mx1, my1));
-        window2 = ofCreateWindow(settings);
-        ofLogNotice() << "Monitor 1: " << mode1->width << "x" << mode1->height;
-        
-        // Create window 3 on monitor 2
-        const GLFWvidmode* mode2 = glfwGetVideoMode(monitors[2]);
-        int mx2, my2;
-        glfwGetMonitorPos(monitors[2], &mx2, &my2);
-        settings.setSize(mode2->width, mode2->height);
-        settings.setPosition(ofVec2f(mx2, my2));
-        window3 = ofCreateWindow(settings);
-        ofLogNotice() << "Monitor 2: " << mode2->width << "x" << mode2->height;
+        for (int i = 1; i < monitorCount; i++) {
+            const GLFWvidmode* mode = glfwGetVideoMode(monitors[i]);
+            int mx, my;
+            glfwGetMonitorPos(monitors[i], &mx, &my);
+            settings.setSize(mode->width, mode->height);
+            settings.setPosition(ofVec2f(mx, my));
+            windows.push_back(ofCreateWindow(settings));
+            ofLogNotice() << "Monitor " << i << ": " << mode->width << "x" << mode->height;
+        }
         
         // Now resize window1 to fullscreen (after other windows created)
-        glfwSetWindowAttrib(glfwGetCurrentContext(), GLFW_DECORATED, GLFW_FALSE);
-        glfwSetWindowPos(glfwGetCurrentContext(), mx0, my0);
-        glfwSetWindowSize(glfwGetCurrentContext(), mode0->width, mode0->height);
+        GLFWwindow* glfwWindow1 = (GLFWwindow*)window1->getWindowContext();
+        glfwSetWindowAttrib(glfwWindow1, GLFW_DECORATED, GLFW_FALSE);
+        glfwSetWindowPos(glfwWindow1, mx0, my0);
+        glfwSetWindowSize(glfwWindow1, mode0->width, mode0->height);
         
-        ofLogNotice() << "Running in FULLSCREEN mode on 3 monitors";
+        ofLogNotice() << "Running in FULLSCREEN mode on " << monitorCount << " monitors";
     } else {
-        // Windowed mode
-        settings.setPosition(ofVec2f(780, 50));
-        window2 = ofCreateWindow(settings);
-        
-        settings.setPosition(ofVec2f(50, 560));
-        window3 = ofCreateWindow(settings);
+        // Windowed mode: two columns of windows
+        for (int i = 1; i < windowedOutputs; i++) {
+            settings.setPosition(ofVec2f(50 + (i % 2) * 730, 50 + (i / 2) * 510));
+            windows.push_back(ofCreateWindow(settings));
+        }
         
         ofLogNotice() << "Running in WINDOWED mode";
     }
     
-    // Create apps after all windows exist
-    auto app1 = make_shared<DisplayApp>();
-    auto app2 = make_shared<DisplayApp>();
-    auto app3 = make_shared<DisplayApp>();
+    globalManager->setNumOutputs(windows.size());
     
-    app1->init(globalManager.get(), 0);
-    app2->init(globalManager.get(), 1);
-    app3->init(globalManager.get(), 2);
+    // Create apps after all windows exist and bind them to their windows
+    for (size_t i = 0; i < windows.size(); i++) {
+        auto app = make_shared<DisplayApp>();
+        app->init(globalManager.get(), i);
+        app->setExternalPacing(USE_OUTPUT_SCHEDULER);
+        app->setUnthrottled(benchmark);
+        ofRunApp(windows[i], app);
+    }
+    
+    if (benchmark) {
+        BenchmarkRunner runner;
+        runner.setup(windows, globalManager.get(), BENCHMARK_WARMUP_FRAMES, benchmarkFrames);
+        return runner.run();
+    }
     
-    // Bind apps to windows
-    ofRunApp(window1, app1);
-    ofRunApp(window2, app2);
-    ofRunApp(window3, app3);
+    if (USE_OUTPUT_SCHEDULER) {
+        OutputScheduler scheduler;
+        scheduler.setup(windows, OUTPUT_TARGET_FPS);
+        return scheduler.run();
+    }
     
     ofRunMainLoop();
     
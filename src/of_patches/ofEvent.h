@@ -12,8 +12,15 @@
 #include <deque>
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <iostream>
 #include <array>
+#include <cstring>
+#include <type_traits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // FIXME: constants deprecated only
 #include "ofConstants.h"
@@ -28,6 +35,7 @@ namespace priv{
 	class NoopMutex{
 	public:
 		void lock(){}
+		bool try_lock(){ return true; }
 		void unlock(){}
 	};
 
@@ -79,20 +87,341 @@ namespace priv{
 	}
 
 	// -------------------------------------
+	// Listener identity, stored by value: object + method for member
+	// functions, the function pointer for free functions, a serial number
+	// for anything else (lambdas can't be compared)
+	class ListenerKey{
+	public:
+		static ListenerKey unique(){
+			static std::atomic<uint64_t> nextSerial{1};
+			ListenerKey key;
+			key.serial = nextSerial++;
+			return key;
+		}
+
+		template<class TObj, typename TMethod>
+		static ListenerKey of(TObj * listener, TMethod method){
+			static_assert(sizeof(TMethod) <= sizeof(ListenerKey::method), "method pointer too large for ListenerKey");
+			ListenerKey key;
+			key.type = &TypeTag<TObj,TMethod>::tag;
+			key.object = listener;
+			std::memcpy(key.method, &method, sizeof(TMethod));
+			return key;
+		}
+
+		bool operator==(const ListenerKey & other) const{
+			return type == other.type && object == other.object && serial == other.serial
+				&& std::memcmp(method, other.method, sizeof(method)) == 0;
+		}
+
+		bool operator!=(const ListenerKey & other) const{
+			return !(*this == other);
+		}
+
+	private:
+		// One address per listener / method type pair
+		template<class TObj, typename TMethod>
+		struct TypeTag{
+			static const char tag;
+		};
+
+		const void * type = nullptr;
+		const void * object = nullptr;
+		uint64_t serial = 0;
+		unsigned char method[3 * sizeof(void*)] = {};
+	};
+
+	template<class TObj, typename TMethod>
+	const char ListenerKey::TypeTag<TObj,TMethod>::tag = 0;
+
+	// -------------------------------------
+	// Type-erased callable with small-buffer storage: an object pointer plus a
+	// member function pointer (or a std::function) fits inline, so a listener
+	// is called through a single indirect call without touching the heap.
+	// Larger callables fall back to a heap copy.
+	template<typename Signature>
+	class Delegate;
+
+	template<typename... Args>
+	class Delegate<bool(Args...)>{
+	public:
+		static const std::size_t BUFFER_SIZE = 4 * sizeof(void*);
+
+		Delegate(){}
+
+		template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+		Delegate(F && function){
+			assign<typename std::decay<F>::type>(std::forward<F>(function), std::integral_constant<bool, fitsInline<typename std::decay<F>::type>()>());
+		}
+
+		Delegate(const Delegate & other){
+			copyFrom(other);
+		}
+
+		Delegate & operator=(const Delegate & other){
+			if(&other != this){
+				reset();
+				copyFrom(other);
+			}
+			return *this;
+		}
+
+		Delegate(Delegate && other) noexcept{
+			moveFrom(other);
+		}
+
+		Delegate & operator=(Delegate && other) noexcept{
+			if(&other != this){
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		~Delegate(){
+			reset();
+		}
+
+		explicit operator bool() const{
+			return invoker != nullptr;
+		}
+
+		inline bool operator()(Args... args) const{
+			return invoker(const_cast<unsigned char*>(storage), std::forward<Args>(args)...);
+		}
+
+	private:
+		enum Operation{ COPY, MOVE, DESTROY };
+		typedef bool (*Invoker)(void * storage, Args...);
+		typedef void (*Manager)(Operation operation, void * storage, const void * source);
+
+		template<typename F>
+		static constexpr bool fitsInline(){
+			return sizeof(F) <= BUFFER_SIZE && alignof(F) <= alignof(void*) && std::is_copy_constructible<F>::value;
+		}
+
+		template<typename F, typename Function>
+		void assign(Function && function, std::true_type){
+			new (storage) F(std::forward<Function>(function));
+			invoker = [](void * storage, Args... args) -> bool{
+				return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+			};
+			// Trivially copyable callables (object + method pointer) are copied with memcpy
+			if(!std::is_trivially_copyable<F>::value){
+				manager = [](Operation operation, void * storage, const void * source){
+					if(operation == COPY){
+						new (storage) F(*static_cast<const F*>(source));
+					}else if(operation == MOVE){
+						F * moved = static_cast<F*>(const_cast<void*>(source));
+						new (storage) F(std::move(*moved));
+						moved->~F();
+					}else{
+						static_cast<F*>(storage)->~F();
+					}
+				};
+			}
+		}
+
+		template<typename F, typename Function>
+		void assign(Function && function, std::false_type){
+			F * heapCopy = new F(std::forward<Function>(function));
+			std::memcpy(storage, &heapCopy, sizeof(heapCopy));
+			invoker = [](void * storage, Args... args) -> bool{
+				return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+			};
+			manager = [](Operation operation, void * storage, const void * source){
+				if(operation == COPY){
+					F * copy = new F(**static_cast<F* const*>(source));
+					std::memcpy(storage, &copy, sizeof(copy));
+				}else if(operation == MOVE){
+					std::memcpy(storage, source, sizeof(F*));
+				}else{
+					delete *static_cast<F**>(storage);
+				}
+			};
+		}
+
+		void copyFrom(const Delegate & other){
+			if(other.manager){
+				other.manager(COPY, storage, other.storage);
+			}else{
+				std::memcpy(storage, other.storage, BUFFER_SIZE);
+			}
+			invoker = other.invoker;
+			manager = other.manager;
+		}
+
+		void moveFrom(Delegate & other){
+			if(other.manager){
+				other.manager(MOVE, storage, other.storage);
+			}else{
+				std::memcpy(storage, other.storage, BUFFER_SIZE);
+			}
+			invoker = other.invoker;
+			manager = other.manager;
+			other.invoker = nullptr;
+			other.manager = nullptr;
+		}
+
+		void reset(){
+			if(manager){
+				manager(DESTROY, storage, nullptr);
+			}
+			invoker = nullptr;
+			manager = nullptr;
+		}
+
+		alignas(void*) unsigned char storage[BUFFER_SIZE] = {};
+		Invoker invoker = nullptr;
+		Manager manager = nullptr;  // Only for callables that aren't trivially copyable
+	};
+
+	// -------------------------------------
+	// A notification raised with notifyDeferred, waiting to be delivered
+	template<typename T>
+	struct DeferredNotification{
+		const void * sender = nullptr;
+		T param{};
+	};
+
+	template<>
+	struct DeferredNotification<void>{
+		const void * sender = nullptr;
+	};
+
+	// -------------------------------------
+	// Bounded multi-producer / single-consumer queue (Vyukov's sequenced
+	// ring): any thread pushes without locking, one thread pops. When it's
+	// full a push fails instead of waiting, and is counted as dropped.
+	// Positions and counters live in this untyped base, so an event holds
+	// and deletes its queue without naming the payload type: only
+	// notifyDeferred / drainDeferred need the payload to be copyable.
+	class DeferredQueueBase{
+	public:
+		explicit DeferredQueueBase(std::size_t minCapacity){
+			std::size_t capacity = 2;
+			while(capacity < minCapacity){
+				capacity *= 2;
+			}
+			mask = capacity - 1;
+		}
+
+		virtual ~DeferredQueueBase(){}
+
+		std::size_t capacity() const{
+			return mask + 1;
+		}
+
+		// Approximate while producers are pushing
+		std::size_t size() const{
+			return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+		}
+
+		std::size_t getHighWater() const{
+			return highWater.load(std::memory_order_relaxed);
+		}
+
+		uint64_t getDropped() const{
+			return dropped.load(std::memory_order_relaxed);
+		}
+
+		void resetHighWater(){
+			highWater.store(size(), std::memory_order_relaxed);
+		}
+
+	protected:
+		std::size_t mask = 0;
+		alignas(64) std::atomic<std::size_t> tail{0};  // Next cell to claim (producers)
+		alignas(64) std::atomic<std::size_t> head{0};  // Next cell to pop (consumer)
+		std::atomic<std::size_t> highWater{0};
+		std::atomic<uint64_t> dropped{0};
+	};
+
+	template<typename Item>
+	class DeferredQueue: public DeferredQueueBase{
+	public:
+		explicit DeferredQueue(std::size_t minCapacity)
+		:DeferredQueueBase(minCapacity){
+			cells.reset(new Cell[capacity()]);
+			for(std::size_t i = 0; i < capacity(); i++){
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		// Any thread
+		bool push(Item && item){
+			std::size_t pos = tail.load(std::memory_order_relaxed);
+			Cell * cell;
+			while(true){
+				cell = &cells[pos & mask];
+				std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+				if(diff == 0){
+					if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+						break;
+					}
+				}else if(diff < 0){
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}else{
+					pos = tail.load(std::memory_order_relaxed);
+				}
+			}
+			cell->item = std::move(item);
+			cell->sequence.store(pos + 1, std::memory_order_release);
+
+			std::size_t depth = pos + 1 - head.load(std::memory_order_relaxed);
+			std::size_t highest = highWater.load(std::memory_order_relaxed);
+			while(depth > highest && !highWater.compare_exchange_weak(highest, depth, std::memory_order_relaxed)){}
+			return true;
+		}
+
+		// Consumer thread only
+		bool pop(Item & item){
+			std::size_t pos = head.load(std::memory_order_relaxed);
+			Cell & cell = cells[pos & mask];
+			if(cell.sequence.load(std::memory_order_acquire) != pos + 1){
+				return false;
+			}
+			item = std::move(cell.item);
+			cell.sequence.store(pos + mask + 1, std::memory_order_release);
+			head.store(pos + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+	private:
+		struct Cell{
+			std::atomic<std::size_t> sequence;
+			Item item;
+		};
+
+		std::unique_ptr<Cell[]> cells;
+	};
+
+	// -------------------------------------
+	// A listener as stored in an event's contiguous listener array
 	template<typename T, class Mutex>
 	class Function{
 	public:
-		Function(int priority, std::function<bool(const void*,T&)> function,  std::unique_ptr<BaseFunctionId>&& id )
+		typedef Delegate<bool(const void*,T&)> Callback;
+		typedef DeferredNotification<T> Deferred;
+
+		Function(){}
+
+		Function(int priority, Callback function, const ListenerKey & id)
 		:priority(priority)
-		,id(std::move(id))
-		,function(function){}
+		,id(id)
+		,function(std::move(function)){}
 
 		bool operator==(const Function<T,Mutex> & f) const{
-			return f.priority == priority && *id == *f.id;
+			return f.priority == priority && id == f.id;
+		}
+
+		const Callback & callback() const{
+			return function;
 		}
 
-		inline bool notify(const void*s,T&t){
-			std::unique_lock<Mutex> lck(mtx);
+		inline bool notify(const void*s,T&t) const{
 			try{
 				return function(s,t);
 			}catch(std::bad_function_call &){
@@ -100,34 +429,36 @@ namespace priv{
 			}
 		}
 
-		inline void disable(){
-			std::unique_lock<Mutex> lck(mtx);
-			function = nullptr;
-		}
-
-		int priority;
-		std::unique_ptr<BaseFunctionId> id;
+		int priority = 0;
+		ListenerKey id;
 
 	private:
-		std::function<bool(const void*,T&)> function;
-		Mutex mtx;
+		Callback function;
 	};
 
 	// -------------------------------------
 	template<class Mutex>
 	class Function<void,Mutex>{
 	public:
-		Function(int priority, std::function<bool(const void*)> function,  std::unique_ptr<BaseFunctionId> && id )
+		typedef Delegate<bool(const void*)> Callback;
+		typedef DeferredNotification<void> Deferred;
+
+		Function(){}
+
+		Function(int priority, Callback function, const ListenerKey & id)
 		:priority(priority)
-		,id(std::move(id))
-		,function(function){}
+		,id(id)
+		,function(std::move(function)){}
 
 		bool operator==(const Function<void,Mutex> & f) const{
-			return f.priority == priority && *id == *f.id;
+			return f.priority == priority && id == f.id;
 		}
 
-		inline bool notify(const void*s){
-			std::unique_lock<Mutex> lck(mtx);
+		const Callback & callback() const{
+			return function;
+		}
+
+		inline bool notify(const void*s) const{
 			try{
 				return function(s);
 			}catch(std::bad_function_call &){
@@ -135,18 +466,44 @@ namespace priv{
 			}
 		}
 
-		inline void disable(){
-			std::unique_lock<Mutex> lck(mtx);
-			function = nullptr;
-		}
-
-		int priority;
-		std::unique_ptr<BaseFunctionId> id;
+		int priority = 0;
+		ListenerKey id;
 	private:
-		std::function<bool(const void*)> function;
-		Mutex mtx;
+		Callback function;
+	};
+
+
+	// -------------------------------------
+	// Notifies running on this thread, innermost first, so a listener that
+	// removes listeners of its own event doesn't wait for itself
+	struct RunningNotify{
+		const void * event;
+		uint32_t epoch;
+		const RunningNotify * outer;
 	};
 
+	inline const RunningNotify *& runningNotifies(){
+		static thread_local const RunningNotify * innermost = nullptr;
+		return innermost;
+	}
+
+	// -------------------------------------
+	inline uint32_t highestBit(uint32_t value){
+#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanReverse(&bit, value);
+		return bit;
+#else
+		return 31 - __builtin_clz(value);
+#endif
+	}
+
+	// -------------------------------------
+	// Slot index + generation of a listener, what tokens remove it by
+	struct ListenerHandle{
+		uint32_t index = 0xffffffff;
+		uint32_t generation = 0;
+	};
 
 	// -------------------------------------
 	template<typename Function, typename Mutex=std::recursive_mutex>
@@ -156,7 +513,7 @@ namespace priv{
 
 		BaseEvent(const BaseEvent & mom){
 			std::unique_lock<Mutex> lck(const_cast<BaseEvent&>(mom).self->mtx);
-			self->functions = mom.self->functions;
+			self->assign(*mom.self);
 		}
 
 		BaseEvent & operator=(const BaseEvent & mom){
@@ -165,15 +522,19 @@ namespace priv{
 			}
 			std::unique_lock<Mutex> lck(const_cast<BaseEvent&>(mom).self->mtx);
 			std::unique_lock<Mutex> lck2(self->mtx);
-			self->functions = mom.self->functions;
+			self->assign(*mom.self);
 			self->enabled = mom.self->enabled;
+			lck.unlock();
+			self->waitForRemoved(lck2);
 			return *this;
 		}
 
 		BaseEvent(BaseEvent && mom){
 			std::unique_lock<Mutex> lck(const_cast<BaseEvent&>(mom).self->mtx);
-			self->functions = std::move(mom.self->functions);
+			self->assign(*mom.self);
 			self->enabled = std::move(mom.self->enabled);
+			mom.self->clear();
+			mom.self->waitForRemoved(lck);
 		}
 
 		BaseEvent & operator=(BaseEvent && mom){
@@ -182,8 +543,10 @@ namespace priv{
 			}
 			std::unique_lock<Mutex> lck(const_cast<BaseEvent&>(mom).self->mtx);
 			std::unique_lock<Mutex> lck2(self->mtx);
-			self->functions = mom.self->functions;
+			self->assign(*mom.self);
 			self->enabled = mom.self->enabled;
+			lck.unlock();
+			self->waitForRemoved(lck2);
 			return *this;
 		}
 
@@ -200,82 +563,474 @@ namespace priv{
 		}
 
 		std::size_t size() const {
-			return self->functions.size();
+			return self->count;
+		}
+
+		// Deferred notifications queue up to this many, set it before the first notifyDeferred
+		void setDeferredCapacity(std::size_t capacity) {
+			self->deferredCapacity = capacity;
+		}
+
+		std::size_t getDeferredPending() const {
+			auto queue = self->deferred.load(std::memory_order_acquire);
+			return queue ? queue->size() : 0;
+		}
+
+		// Most notifications waiting at once since the last reset
+		std::size_t getDeferredHighWater() const {
+			auto queue = self->deferred.load(std::memory_order_acquire);
+			return queue ? queue->getHighWater() : 0;
+		}
+
+		// Notifications lost to a full queue
+		uint64_t getDeferredDropped() const {
+			auto queue = self->deferred.load(std::memory_order_acquire);
+			return queue ? queue->getDropped() : 0;
+		}
+
+		void resetDeferredHighWater() {
+			auto queue = self->deferred.load(std::memory_order_acquire);
+			if(queue){
+				queue->resetHighWater();
+			}
 		}
 
 	protected:
 
+		typedef typename Function::Callback Callback;
+
+		struct Data;
+
+		// Immutable, contiguous list of the listeners' slots in priority order,
+		// which notify walks. The callbacks stay in their slots, so a stateful
+		// listener keeps its state across snapshots. An entry is live while its
+		// slot's generation still matches, so removing a listener never has to
+		// touch the snapshots that hold it.
+		struct Snapshot{
+			struct Entry{
+				const typename Data::Slot * slot;
+				uint32_t liveGeneration;
+			};
+			std::vector<Entry> entries;
+		};
+
 		struct Data{
-			Mutex mtx;
-			std::vector<std::shared_ptr<Function>> functions;
+			typedef std::vector<Function> Functions;
+			typedef DeferredQueue<typename Function::Deferred> Queue;
+
+			static const uint32_t FIRST_PAGE_SIZE = 4;   // Each new page doubles
+
+			// Listeners live in a slot map: slots are reused through a free
+			// list and linked in priority order, so adding never shifts others
+			// and removing by handle is constant time
+			struct Slot{
+				Function function;
+				Slot * prev = nullptr;
+				Slot * next = nullptr;  // Priority order, or the next free slot
+				uint32_t index = 0;     // What handles find it by
+				bool used = false;
+				std::atomic<uint32_t> generation{0};  // Bumped when its listener is removed
+			};
+
+			Mutex mtx;              // Serializes add / remove, notify never takes it
+			// Pages never move or go away, so snapshots can point at their slots
+			std::vector<std::unique_ptr<Slot[]>> pages;
+			uint32_t capacity = 0;
+			Slot * freeSlots = nullptr;
+			Slot * first = nullptr;
+			Slot * last = nullptr;
+			std::size_t count = 0;
 			bool enabled = true;
 
-			void remove(const BaseFunctionId & id){
+			// The snapshot notify reads with one atomic load. Adding publishes a
+			// new one; removals only leave dead entries behind until they make up
+			// half of it. Notifies count themselves in the current epoch, by its
+			// parity. The epoch only moves on once no notify of the one before is
+			// left, so replaced snapshots and removed listeners retired in epoch e
+			// are out of every notify's reach once it gets to e + 2. Whoever gets
+			// there first frees them, a writer or the last notify out.
+			struct Retired{
+				uint32_t epoch;
+				const Snapshot * snapshot;  // One of the two
+				Slot * slot;
+			};
+			std::atomic<const Snapshot*> snapshot{nullptr};
+			std::atomic<uint32_t> epoch{0};
+			std::atomic<int> readers[2] = {{0}, {0}};
+			std::deque<Retired> retired;  // Oldest first
+			std::atomic<bool> reclaimPending{false};
+			std::size_t deadEntries = 0;
+
+			// Created by the first notifyDeferred, from whichever thread gets there
+			std::atomic<DeferredQueueBase*> deferred{nullptr};
+			std::size_t deferredCapacity = 64;
+
+			~Data(){
+				delete deferred.load();
+				delete snapshot.load();
+				for(auto & old: retired){
+					delete old.snapshot;
+				}
+			}
+
+			// Notify: counts itself in the current epoch, returns it
+			uint32_t enter(){
+				while(true){
+					uint32_t current = epoch.load();
+					readers[current & 1].fetch_add(1);
+					// Confirmed after counting, so moving the epoch on can't miss it
+					if(epoch.load() == current){
+						return current;
+					}
+					leave(current);
+				}
+			}
+
+			void leave(uint32_t readerEpoch){
+				if(readers[readerEpoch & 1].fetch_sub(1) == 1 && reclaimPending.load()){
+					// Never waits on the writers: a later writer or notify will do it
+					std::unique_lock<Mutex> lck(mtx, std::try_to_lock);
+					if(lck.owns_lock()){
+						reclaim();
+					}
+				}
+			}
+
+			// Call with mtx held. Moves the epoch on, unless a notify of the
+			// previous one is still running.
+			bool advance(){
+				uint32_t current = epoch.load();
+				if(readers[(current + 1) & 1].load() != 0){
+					return false;
+				}
+				epoch.store(current + 1);
+				return true;
+			}
+
+			// Call with mtx held
+			void reclaim(){
+				while(!retired.empty()){
+					if(epoch.load() - retired.front().epoch < 2){
+						if(!advance()){
+							break;
+						}
+						continue;
+					}
+					auto & old = retired.front();
+					delete old.snapshot;
+					if(old.slot){
+						release(*old.slot);
+					}
+					retired.pop_front();
+				}
+				reclaimPending.store(!retired.empty());
+			}
+
+			Queue * deferredQueue(){
+				DeferredQueueBase * queue = deferred.load(std::memory_order_acquire);
+				if(!queue){
+					Queue * created = new Queue(deferredCapacity);
+					if(deferred.compare_exchange_strong(queue, created, std::memory_order_acq_rel)){
+						queue = created;
+					}else{
+						delete created;
+					}
+				}
+				return static_cast<Queue*>(queue);
+			}
+
+			// Page p starts at FIRST_PAGE_SIZE * (2^p - 1)
+			Slot & slot(uint32_t index){
+				uint32_t n = index + FIRST_PAGE_SIZE;
+				uint32_t page = highestBit(n) - highestBit(FIRST_PAGE_SIZE);
+				return pages[page][n - (FIRST_PAGE_SIZE << page)];
+			}
+
+			// Call with mtx held
+			ListenerHandle insert(Function && function){
+				if(!freeSlots){
+					uint32_t size = FIRST_PAGE_SIZE << pages.size();
+					pages.emplace_back(new Slot[size]);
+					for(uint32_t i = size; i > 0; i--){
+						Slot & s = pages.back()[i - 1];
+						s.index = capacity + i - 1;
+						s.next = freeSlots;
+						freeSlots = &s;
+					}
+					capacity += size;
+				}
+				Slot & s = *freeSlots;
+				freeSlots = s.next;
+				s.function = std::move(function);
+				s.used = true;
+
+				// After every listener of the same or lower priority, searching
+				// from the back: appending at one priority is constant time
+				Slot * after = last;
+				while(after && after->function.priority > s.function.priority){
+					after = after->prev;
+				}
+				s.prev = after;
+				s.next = after ? after->next : first;
+				(s.prev ? s.prev->next : first) = &s;
+				(s.next ? s.next->prev : last) = &s;
+				count++;
+
+				return handleOf(s);
+			}
+
+			ListenerHandle handleOf(const Slot & s){
+				ListenerHandle handle;
+				handle.index = s.index;
+				handle.generation = s.generation.load(std::memory_order_relaxed);
+				return handle;
+			}
+
+			// Call with mtx held. Takes the listener out of the list and retires
+			// its slot, which reclaim() releases once no notify can still call it.
+			bool unlink(ListenerHandle handle){
+				if(handle.index >= capacity){
+					return false;
+				}
+				Slot & s = slot(handle.index);
+				if(!s.used || s.generation.load(std::memory_order_relaxed) != handle.generation){
+					return false;
+				}
+
+				// Snapshots still holding it skip it from now on
+				s.generation.store(handle.generation + 1);
+				(s.prev ? s.prev->next : first) = s.next;
+				(s.next ? s.next->prev : last) = s.prev;
+				s.used = false;
+				s.prev = nullptr;
+				s.next = nullptr;
+				count--;
+				retired.push_back({epoch.load(), nullptr, &s});
+				reclaimPending.store(true);
+
+				// Compact once dead entries make up half the snapshot
+				deadEntries++;
+				const Snapshot * current = snapshot.load(std::memory_order_relaxed);
+				if(count == 0 || (current && deadEntries * 2 > current->entries.size())){
+					publish();
+				}
+				return true;
+			}
+
+			// Call with mtx held. Destroys the callable and whatever it captured.
+			void release(Slot & s){
+				s.function = Function();
+				s.next = freeSlots;
+				freeSlots = &s;
+			}
+
+			// Returns once no other thread can still be calling a listener
+			// removed so far, waiting without holding mtx so those calls can
+			// still add and remove listeners. Unless this thread is inside a
+			// notify of this event itself, the removed listeners are released by
+			// then; otherwise they go once that notify returns. lck is the only
+			// lock the caller may hold.
+			void waitForRemoved(std::unique_lock<Mutex> & lck){
+				uint32_t removedAt = epoch.load();
+				int own[2] = {0, 0};
+				for(auto running = runningNotifies(); running; running = running->outer){
+					if(running->event == this){
+						own[running->epoch & 1]++;
+					}
+				}
+				// Notifies that could have seen them counted in removedAt or the
+				// epoch before. Either count dropping to this thread's own, or the
+				// epoch moving past it, means they're gone.
+				bool previousLeft = false;
+				bool currentLeft = false;
+				while(true){
+					while(epoch.load() - removedAt < 2 && advance()){}
+					reclaim();
+					uint32_t passed = epoch.load() - removedAt;
+					previousLeft = previousLeft || passed >= 1 || readers[(removedAt + 1) & 1].load() == own[(removedAt + 1) & 1];
+					currentLeft = currentLeft || passed >= 2 || readers[removedAt & 1].load() == own[removedAt & 1];
+					if(previousLeft && currentLeft){
+						return;
+					}
+					lck.unlock();
+					std::this_thread::yield();
+					lck.lock();
+				}
+			}
+
+			void erase(std::unique_lock<Mutex> & lck, ListenerHandle handle){
+				if(unlink(handle)){
+					waitForRemoved(lck);
+				}
+			}
+
+			// Call with mtx held after adding
+			void publish(){
+				Snapshot * next = nullptr;
+				if(count > 0){
+					next = new Snapshot;
+					next->entries.reserve(count);
+					for(const Slot * s = first; s; s = s->next){
+						next->entries.push_back({s, s->generation.load(std::memory_order_relaxed)});
+					}
+				}
+				deadEntries = 0;
+				const Snapshot * previous = snapshot.exchange(next);
+				if(previous){
+					retired.push_back({epoch.load(), previous, nullptr});
+				}
+				reclaim();
+			}
+
+			// First listener with this id, in priority order (the add / remove API)
+			void remove(const ListenerKey & id){
 				std::unique_lock<Mutex> lck(mtx);
-				auto it = functions.begin();
-				for(; it!=functions.end(); ++it){
-					auto f = *it;
-					if(*f->id == id){
-						f->disable();
-						functions.erase(it);
+				for(Slot * s = first; s; s = s->next){
+					if(s->function.id == id){
+						erase(lck, handleOf(*s));
 						break;
 					}
 				}
 			}
+
+			void remove(ListenerHandle handle){
+				std::unique_lock<Mutex> lck(mtx);
+				erase(lck, handle);
+			}
+
+			// Call with mtx held, then waitForRemoved()
+			void clear(){
+				while(first){
+					unlink(handleOf(*first));
+				}
+			}
+
+			// Call with both events' mtx held, then waitForRemoved() once
+			// other's is unlocked
+			void assign(Data & other){
+				Functions functions;
+				for(const Slot * s = other.first; s; s = s->next){
+					functions.push_back(s->function);
+				}
+				clear();
+				for(auto & function: functions){
+					insert(std::move(function));
+				}
+				publish();
+			}
 		};
 		std::shared_ptr<Data> self{new Data};
 
+		// Calls notifyOne on each live callback of the current snapshot, in
+		// priority order, until one returns true. No lock, no copy, no allocation.
+		template<typename NotifyOne>
+		inline bool notifyFunctions(NotifyOne && notifyOne){
+			if(!self->enabled){
+				return false;
+			}
+			// Leaves its epoch even if a listener throws
+			struct Reader{
+				Data & data;
+				RunningNotify running;
+				const RunningNotify *& innermost;
+				~Reader(){
+					innermost = running.outer;
+					data.leave(running.epoch);
+				}
+			};
+			const RunningNotify *& innermost = runningNotifies();
+			Reader reader{*self, {self.get(), self->enter(), innermost}, innermost};
+			innermost = &reader.running;
+
+			bool attended = false;
+			const Snapshot * snapshot = reader.data.snapshot.load();
+			if(snapshot){
+				for(auto & entry: snapshot->entries){
+					// A remove that bumps the generation after this waits for the
+					// notify to leave its epoch
+					if(entry.slot->generation.load() == entry.liveGeneration && notify(notifyOne, entry.slot->function.callback())){
+						attended = true;
+						break;
+					}
+				}
+			}
+			return attended;
+		}
+
+		template<typename NotifyOne>
+		static inline bool notify(NotifyOne & notifyOne, const Callback & callback){
+			try{
+				return notifyOne(callback);
+			}catch(std::bad_function_call &){
+				return false;
+			}
+		}
+
+		typedef typename Function::Deferred Deferred;
+
+		bool pushDeferred(Deferred && notification){
+			return self->deferredQueue()->push(std::move(notification));
+		}
+
+		// Consumer thread: hands up to maxBatch queued notifications to deliver, oldest first
+		template<typename Deliver>
+		std::size_t drainNotifications(std::size_t maxBatch, Deliver && deliver){
+			auto queue = static_cast<typename Data::Queue*>(self->deferred.load(std::memory_order_acquire));
+			if(!queue){
+				return 0;
+			}
+			Deferred notification;
+			std::size_t delivered = 0;
+			while(delivered < maxBatch && queue->pop(notification)){
+				deliver(notification);
+				delivered++;
+			}
+			return delivered;
+		}
+
 		class EventToken: public AbstractEventToken{
 			public:
 				EventToken() {};
-				template<typename Id>
-				EventToken(std::shared_ptr<Data> & event, const Id & id)
+				EventToken(std::shared_ptr<Data> & event, ListenerHandle handle)
 				:event(event)
-				,id(id.clone()){
+				,handle(handle){
 
 				}
 
 				~EventToken(){
 					auto event = this->event.lock();
 					if(event){
-						event->remove(*id);
+						event->remove(handle);
 					}
 				}
 
 			private:
 				std::weak_ptr<Data> event;
-				std::unique_ptr<BaseFunctionId> id;
+				ListenerHandle handle;
 		};
 
-		std::unique_ptr<EventToken> make_token(const Function & f){
-			return std::make_unique<EventToken>(self,*f.id);
+		std::unique_ptr<EventToken> make_token(ListenerHandle handle){
+			return std::make_unique<EventToken>(self,handle);
 		}
 
 		template<typename TFunction>
 		void addNoToken(TFunction && f){
 			std::unique_lock<Mutex> lck(self->mtx);
-			auto it = self->functions.begin();
-			for(; it!=self->functions.end(); ++it){
-				if((*it)->priority>f->priority) break;
-			}
-			self->functions.emplace(it, f);
+			self->insert(std::forward<TFunction>(f));
+			self->publish();
 		}
 
 		template<typename TFunction>
 		std::unique_ptr<EventToken> addFunction(TFunction && f){
 			std::unique_lock<Mutex> lck(self->mtx);
-			auto it = self->functions.begin();
-			for(; it!=self->functions.end(); ++it){
-				if((*it)->priority>f->priority) break;
-			}
-			self->functions.emplace(it, f);
-			return make_token(*f);
+			auto handle = self->insert(std::forward<TFunction>(f));
+			self->publish();
+			return make_token(handle);
 		}
 	};
 
 
 
-
 	// -------------------------------------
 	// Helper functions to disambiguate parameters
 	// https://github.com/sth/callable.hpp
@@ -444,97 +1199,131 @@ template<typename T, typename Mutex=std::recursive_mutex>
 class ofEvent: public of::priv::BaseEvent<of::priv::Function<T,Mutex>,Mutex>{
 protected:
 	typedef of::priv::Function<T,Mutex> Function;
-	typedef std::shared_ptr<Function> FunctionPtr;
+	typedef of::priv::ListenerKey ListenerKey;
 
 	template<class TObj, typename TMethod>
-	class FunctionId: public of::priv::BaseFunctionId{
-	public:
-		TObj * listener;
-		TMethod method;
-
-		FunctionId(TObj * listener, TMethod method)
-		:listener(listener)
-		,method(method){
-
-		}
-
-		BaseFunctionId * clone() const{
-			return new FunctionId<TObj,TMethod>(listener, method);
-		}
-
-		template<typename F>
-		bool operator==(const F & f1) const{
-			return f1.listener == this->listener && f1.method == this->method;
-		}
-
-		bool operator==(const BaseFunctionId & f) const{
-			const auto * other = dynamic_cast<const FunctionId<TObj,TMethod>*>(&f);
-			return other && other->listener == this->listener && other->method == this->method;
-		}
-	};
-
-	template<class TObj, typename TMethod>
-	std::unique_ptr<FunctionId<TObj,TMethod>> make_function_id(TObj * listener, TMethod method){
-		return std::make_unique<FunctionId<TObj,TMethod>>(listener,method);
+	ListenerKey make_function_id(TObj * listener, TMethod method){
+		return ListenerKey::of(listener,method);
 	}
 
+	// Member functions: object + method pointer, stored inline in the listener
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, bool (TObj::*method)(T&), int priority){
-		return std::make_shared<Function>(priority, std::bind(method,listener,std::placeholders::_2), make_function_id(listener,method));
+	Function make_function(TObj * listener, bool (TObj::*method)(T&), int priority){
+		return Function(priority, [listener, method](const void*, T&t){
+			return (listener->*method)(t);
+		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, void (TObj::*method)(T&), int priority){
-		return std::make_shared<Function>(priority, [listener, method](const void*, T&t){
+	Function make_function(TObj * listener, void (TObj::*method)(T&), int priority){
+		return Function(priority, [listener, method](const void*, T&t){
 			((listener)->*(method))(t);
 			return false;
 		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, bool (TObj::*method)(const void*, T&), int priority){
-		return std::make_shared<Function>(priority, std::bind(method,listener,std::placeholders::_1,std::placeholders::_2), make_function_id(listener,method));
+	Function make_function(TObj * listener, bool (TObj::*method)(const void*, T&), int priority){
+		return Function(priority, [listener, method](const void*s, T&t){
+			return (listener->*method)(s,t);
+		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, void (TObj::*method)(const void*, T&), int priority){
-		return std::make_shared<Function>(priority, [listener, method](const void*s, T&t){
+	Function make_function(TObj * listener, void (TObj::*method)(const void*, T&), int priority){
+		return Function(priority, [listener, method](const void*s, T&t){
 			(listener->*method)(s,t);
 			return false;
 		}, make_function_id(listener,method));
 	}
 
 	template<typename F>
-	std::unique_ptr<of::priv::BaseFunctionId> make_std_function_id(const F & f){
+	ListenerKey make_std_function_id(const F & f){
 		auto function = f.template target<typename of::priv::callable_traits<F>::function_ptr>();
 		if(function){
 			return make_function_id((ofEvent<T>*)nullptr,*function);
 		}else{
-			return of::priv::make_function_id();
+			return ListenerKey::unique();
 		}
 	}
 
-	FunctionPtr make_function(std::function<bool(T&)> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*, T&t) {return f(t); }, make_std_function_id(f));
+	Function make_function(std::function<bool(T&)> f, int priority) {
+		return Function(priority, [f](const void*, T&t) {return f(t); }, make_std_function_id(f));
+	}
+
+	Function make_function(std::function<bool(const void*, T&)> f, int priority) {
+		auto id = make_std_function_id(f);
+		return Function(priority, std::move(f), id);
 	}
 
-	FunctionPtr make_function(std::function<bool(const void*, T&)> f, int priority) {
-		return std::make_shared<Function>(priority, f, make_std_function_id(f));
+	Function make_function(std::function<void(T&)> f, int priority) {
+		return Function(priority, [f](const void*, T&t) {f(t); return false; }, make_std_function_id(f));
 	}
 
-	FunctionPtr make_function(std::function<void(T&)> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*, T&t) {f(t); return false; }, make_std_function_id(f));
+	Function make_function(std::function<void(const void*, T&)> f, int priority) {
+		return Function(priority, [f](const void*s, T&t) {f(s, t); return false; }, make_std_function_id(f));
 	}
 
-	FunctionPtr make_function(std::function<void(const void*, T&)> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*s, T&t) {f(s, t); return false; }, make_std_function_id(f));
+	// Callables with one of the listener signatures are stored as they are,
+	// without a std::function in between; anything else converts as before
+	template<typename F>
+	ListenerKey make_callable_id(const F &){
+		return ListenerKey::unique();
 	}
 
+	template<typename R, typename... Args>
+	ListenerKey make_callable_id(R (*function)(Args...)){
+		return make_function_id((ofEvent<T>*)nullptr,function);
+	}
+
+	template<typename R, typename... Args>
+	ListenerKey make_callable_id(const std::function<R(Args...)> & f){
+		return make_std_function_id(f);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, bool (*)(T&)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*, T&t) mutable {return f(t); }, id);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, void (*)(T&)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*, T&t) mutable {f(t); return false; }, id);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, bool (*)(const void*, T&)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*s, T&t) mutable {return f(s, t); }, id);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, void (*)(const void*, T&)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*s, T&t) mutable {f(s, t); return false; }, id);
+	}
+
+	template<typename F, typename Signature>
+	Function make_callable(F f, int priority, Signature){
+		return make_function(std::function<typename of::priv::callable_traits<F>::function_type>(f), priority);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority){
+		return make_callable(std::move(f), priority, (typename of::priv::callable_traits<F>::function_ptr)nullptr);
+	}
 
 	using of::priv::BaseEvent<of::priv::Function<T,Mutex>,Mutex>::addFunction;
 	using of::priv::BaseEvent<of::priv::Function<T,Mutex>,Mutex>::addNoToken;
 
 public:
+	/// Removing a listener, with remove() or by destroying its token, waits
+	/// for calls to it already running on other threads, so the listener can
+	/// be destroyed right after. A call on the removing thread itself (a
+	/// listener removing itself) isn't waited for. Don't remove a listener
+	/// while holding a lock that listener's callback takes.
 	template<class TObj, typename TMethod>
 	std::unique_ptr<of::priv::AbstractEventToken> newListener(TObj * listener, TMethod method, int priority = OF_EVENT_ORDER_AFTER_APP){
 		return addFunction(make_function(listener,method,priority));
@@ -547,50 +1336,56 @@ public:
 
 	template<class TObj, typename TMethod>
 	void remove(TObj * listener, TMethod method, int priority){
-		 ofEvent<T,Mutex>::self->remove(*make_function_id(listener,method));
+		 ofEvent<T,Mutex>::self->remove(make_function_id(listener,method));
 	}
 
 	template<typename TFunction>
 	std::unique_ptr<of::priv::AbstractEventToken> newListener(TFunction function, int priority = OF_EVENT_ORDER_AFTER_APP) {
-		return addFunction(make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function), priority));
+		return addFunction(make_callable(std::move(function), priority));
 	}
 
 	template<typename TFunction>
 	void add(TFunction function, int priority){
-		addNoToken(make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function),priority));
+		addNoToken(make_callable(std::move(function), priority));
 	}
 
 	template<typename TFunction>
 	void remove(TFunction function, int priority){
-		 ofEvent<T,Mutex>::self->remove(*make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function), priority)->id);
+		 ofEvent<T,Mutex>::self->remove(make_std_function_id(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function)));
 	}
 
 	inline bool notify(const void* sender, T & param){
-		if(ofEvent<T,Mutex>::self->enabled && !ofEvent<T,Mutex>::self->functions.empty()){
-			std::unique_lock<Mutex> lck(ofEvent<T,Mutex>::self->mtx);
-			auto functions_copy = ofEvent<T,Mutex>::self->functions;
-			lck.unlock();
-			for(auto & f: functions_copy){
-                if(f->notify(sender,param)){
-					return true;
-                }
-			}
-		}
-		return false;
+		return this->notifyFunctions([&](const typename Function::Callback & callback){
+			return callback(sender,param);
+		});
 	}
 
 	inline bool notify(T & param){
-		if(ofEvent<T,Mutex>::self->enabled && !ofEvent<T,Mutex>::self->functions.empty()){
-			std::unique_lock<Mutex> lck(ofEvent<T,Mutex>::self->mtx);
-			auto functions_copy = ofEvent<T,Mutex>::self->functions;
-			lck.unlock();
-			for(auto & f: functions_copy){
-				if(f->notify(nullptr,param)){
-					return true;
-				}
-			}
-		}
-		return false;
+		return this->notifyFunctions([&](const typename Function::Callback & callback){
+			return callback(nullptr,param);
+		});
+	}
+
+	/// Queues a copy of param from any thread, without locking, to be
+	/// notified on the thread that calls drainDeferred(). Returns false if
+	/// the queue was full and the notification was dropped.
+	bool notifyDeferred(const void* sender, const T & param){
+		typename Function::Deferred notification;
+		notification.sender = sender;
+		notification.param = param;
+		return this->pushDeferred(std::move(notification));
+	}
+
+	bool notifyDeferred(const T & param){
+		return notifyDeferred(nullptr, param);
+	}
+
+	/// Notifies up to maxBatch queued notifications in the order they were
+	/// queued. Only ever call it from one thread.
+	std::size_t drainDeferred(std::size_t maxBatch = std::numeric_limits<std::size_t>::max()){
+		return this->drainNotifications(maxBatch, [this](typename Function::Deferred & notification){
+			ofEvent<T,Mutex>::notify(notification.sender, notification.param);
+		});
 	}
 };
 
@@ -602,97 +1397,126 @@ template<typename Mutex>
 class ofEvent<void,Mutex>: public of::priv::BaseEvent<of::priv::Function<void,Mutex>,Mutex>{
 protected:
 	typedef of::priv::Function<void,Mutex> Function;
-	typedef std::shared_ptr<Function> FunctionPtr;
-
-	template<class TObj, typename TMethod>
-	class FunctionId: public of::priv::BaseFunctionId{
-	public:
-		TObj * listener;
-		TMethod method;
-
-		FunctionId(TObj * listener, TMethod method)
-		:listener(listener)
-		,method(method){
-
-		}
-
-		BaseFunctionId * clone() const{
-			return new FunctionId<TObj,TMethod>(listener, method);
-		}
-
-		template<typename F>
-		bool operator==(const F & f1) const{
-			return f1.listener == this->listener && f1.method == this->method;
-		}
-
-		bool operator==(const BaseFunctionId & f) const{
-			const auto * other = dynamic_cast<const FunctionId<TObj,TMethod>*>(&f);
-			return other && other->listener == this->listener && other->method == this->method;
-		}
-	};
-
+	typedef of::priv::ListenerKey ListenerKey;
 
 	template<class TObj, typename TMethod>
-	std::unique_ptr<FunctionId<TObj,TMethod>> make_function_id(TObj * listener, TMethod method){
-		return std::unique_ptr<FunctionId<TObj,TMethod>>(new FunctionId<TObj,TMethod>(listener,method));
+	ListenerKey make_function_id(TObj * listener, TMethod method){
+		return ListenerKey::of(listener,method);
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, bool (TObj::*method)(), int priority){
-		return std::make_shared<Function>(priority, std::bind(method,listener), make_function_id(listener,method));
+	Function make_function(TObj * listener, bool (TObj::*method)(), int priority){
+		return Function(priority,[listener, method](const void*){
+			return (listener->*method)();
+		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, void (TObj::*method)(), int priority){
-		return std::make_shared<Function>(priority,[listener, method](const void*){
+	Function make_function(TObj * listener, void (TObj::*method)(), int priority){
+		return Function(priority,[listener, method](const void*){
 			(listener->*method)();
 			return false;
 		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, bool (TObj::*method)(const void*), int priority){
-		return std::make_shared<Function>(priority,std::bind(method,listener,std::placeholders::_1), make_function_id(listener,method));
+	Function make_function(TObj * listener, bool (TObj::*method)(const void*), int priority){
+		return Function(priority,[listener, method](const void* sender){
+			return (listener->*method)(sender);
+		}, make_function_id(listener,method));
 	}
 
 	template<class TObj>
-	FunctionPtr make_function(TObj * listener, void (TObj::*method)(const void*), int priority){
-		return std::make_shared<Function>(priority,[listener, method](const void* sender){
+	Function make_function(TObj * listener, void (TObj::*method)(const void*), int priority){
+		return Function(priority,[listener, method](const void* sender){
 			(listener->*method)(sender);
 			return false;
 		}, make_function_id(listener,method));
 	}
 
 	template<typename F>
-	std::unique_ptr<of::priv::BaseFunctionId> make_std_function_id(const F & f){
+	ListenerKey make_std_function_id(const F & f){
 		auto function = f.template target<typename of::priv::callable_traits<F>::function_ptr>();
 		if(function){
 			return make_function_id((ofEvent<void>*)nullptr,*function);
 		}else{
-			return of::priv::make_function_id();
+			return ListenerKey::unique();
 		}
 	}
 
-	FunctionPtr make_function(std::function<bool()> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*) {return f(); }, make_std_function_id(f));
+	Function make_function(std::function<bool()> f, int priority) {
+		return Function(priority, [f](const void*) {return f(); }, make_std_function_id(f));
+	}
+
+	Function make_function(std::function<bool(const void*)> f, int priority) {
+		auto id = make_std_function_id(f);
+		return Function(priority, std::move(f), id);
+	}
+
+	Function make_function(std::function<void()> f, int priority) {
+		return Function(priority, [f](const void*) {f(); return false; }, make_std_function_id(f));
+	}
+
+	Function make_function(std::function<void(const void*)> f, int priority) {
+		return Function(priority, [f](const void*s) {f(s); return false; }, make_std_function_id(f));
+	}
+
+	// Callables with one of the listener signatures are stored as they are,
+	// without a std::function in between; anything else converts as before
+	template<typename F>
+	ListenerKey make_callable_id(const F &){
+		return ListenerKey::unique();
+	}
+
+	template<typename R, typename... Args>
+	ListenerKey make_callable_id(R (*function)(Args...)){
+		return make_function_id((ofEvent<void>*)nullptr,function);
 	}
 
-	FunctionPtr make_function(std::function<bool(const void*)> f, int priority) {
-		return std::make_shared<Function>(priority, f, make_std_function_id(f));
+	template<typename R, typename... Args>
+	ListenerKey make_callable_id(const std::function<R(Args...)> & f){
+		return make_std_function_id(f);
 	}
 
-	FunctionPtr make_function(std::function<void()> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*) {f(); return false; }, make_std_function_id(f));
+	template<typename F>
+	Function make_callable(F f, int priority, bool (*)()){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*) mutable {return f(); }, id);
 	}
 
-	FunctionPtr make_function(std::function<void(const void*)> f, int priority) {
-		return std::make_shared<Function>(priority, [f](const void*s) {f(s); return false; }, make_std_function_id(f));
+	template<typename F>
+	Function make_callable(F f, int priority, void (*)()){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*) mutable {f(); return false; }, id);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, bool (*)(const void*)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*s) mutable {return f(s); }, id);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority, void (*)(const void*)){
+		auto id = make_callable_id(f);
+		return Function(priority, [f](const void*s) mutable {f(s); return false; }, id);
+	}
+
+	template<typename F, typename Signature>
+	Function make_callable(F f, int priority, Signature){
+		return make_function(std::function<typename of::priv::callable_traits<F>::function_type>(f), priority);
+	}
+
+	template<typename F>
+	Function make_callable(F f, int priority){
+		return make_callable(std::move(f), priority, (typename of::priv::callable_traits<F>::function_ptr)nullptr);
 	}
 
 	using of::priv::BaseEvent<of::priv::Function<void,Mutex>,Mutex>::addFunction;
 	using of::priv::BaseEvent<of::priv::Function<void,Mutex>,Mutex>::addNoToken;
 
 public:
+	/// Removing waits for calls on other threads, as with ofEvent<T>
 	template<class TObj, typename TMethod>
 	void add(TObj * listener, TMethod method, int priority){
 		addNoToken(make_function(listener,method,priority));
@@ -705,68 +1529,62 @@ public:
 
 	template<class TObj, typename TMethod>
 	void remove(TObj * listener, TMethod method, int priority){
-		ofEvent<void,Mutex>::self->remove(*make_function_id(listener,method));
+		ofEvent<void,Mutex>::self->remove(make_function_id(listener,method));
 	}
 
 	template<typename TFunction>
 	void add(TFunction function, int priority){
-		addNoToken(make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function),priority));
+		addNoToken(make_callable(std::move(function), priority));
 	}
 
 	template<typename TFunction>
 	std::unique_ptr<of::priv::AbstractEventToken> newListener(TFunction function, int priority = OF_EVENT_ORDER_AFTER_APP) {
-		return addFunction(make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function), priority));
+		return addFunction(make_callable(std::move(function), priority));
 	}
 
 	template<typename TFunction>
 	void remove(TFunction function, int priority){
-		 ofEvent<void,Mutex>::self->remove(*make_function(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function),priority)->id);
+		 ofEvent<void,Mutex>::self->remove(make_std_function_id(std::function<typename of::priv::callable_traits<TFunction>::function_type>(function)));
 	}
 
 	bool notify(const void* sender){
-		if(ofEvent<void,Mutex>::self->enabled && !ofEvent<void,Mutex>::self->functions.empty()){
-			std::unique_lock<Mutex> lck(ofEvent<void,Mutex>::self->mtx);
-			auto functions_copy = ofEvent<void,Mutex>::self->functions;
-			lck.unlock();
-			for(auto & f: functions_copy){
-				if(f->notify(sender)){
-					return true;
-				}
-			}
-		}
-		return false;
+		return this->notifyFunctions([&](const typename Function::Callback & callback){
+			return callback(sender);
+		});
 	}
 
 	bool notify(){
-		if(ofEvent<void,Mutex>::self->enabled && !ofEvent<void,Mutex>::self->functions.empty()){
-			std::unique_lock<Mutex> lck(ofEvent<void,Mutex>::self->mtx);
-			auto functions_copy = ofEvent<void,Mutex>::self->functions;
-			lck.unlock();
-			for(auto & f: functions_copy){
-				if(f->notify(nullptr)){
-					return true;
-				}
-			}
-		}
-		return false;
+		return this->notifyFunctions([&](const typename Function::Callback & callback){
+			return callback(nullptr);
+		});
+	}
+
+	/// Queues the notification from any thread, without locking, to be
+	/// notified on the thread that calls drainDeferred(). Returns false if
+	/// the queue was full and the notification was dropped.
+	bool notifyDeferred(const void* sender = nullptr){
+		typename Function::Deferred notification;
+		notification.sender = sender;
+		return this->pushDeferred(std::move(notification));
+	}
+
+	/// Notifies up to maxBatch queued notifications in the order they were
+	/// queued. Only ever call it from one thread.
+	std::size_t drainDeferred(std::size_t maxBatch = std::numeric_limits<std::size_t>::max()){
+		return this->drainNotifications(maxBatch, [this](typename Function::Deferred & notification){
+			notify(notification.sender);
+		});
 	}
 };
 
 // -------------------------------------
-/// Non thread safe event that avoids locks and copies of the listeners
-/// making it faster than a plain ofEvent
+/// Non thread safe event: nothing locks, so only ever use it from one
+/// thread, notify included
 template<typename T>
 class ofFastEvent: public ofEvent<T,of::priv::NoopMutex>{
 public:
 	inline bool notify(const void* sender, T & param){
-		if(this->isEnabled()){
-			for(auto & f: ofFastEvent<T>::self->functions){
-				if(f->notify(sender, param)){
-					return true;
-				}
-			}
-		}
-		return false;
+		return ofEvent<T,of::priv::NoopMutex>::notify(sender, param);
 	}
 };
 